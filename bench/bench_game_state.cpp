@@ -0,0 +1,115 @@
+// Tick-path serialization benchmark: nlohmann tree + dump() vs the streaming
+// writer used by Room::broadcast_game_state(). Checks both produce identical
+// JSON and counts heap allocations per steady-state Room::update().
+//
+//   cmake -B build -DBUILD_BENCHMARKS=ON && cmake --build build --target bench_game_state
+//   ./build/bench_game_state
+
+#include "game/room.h"
+#include "network/json_writer.h"
+#include "utils/logger.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<long> g_allocs{0};
+
+void* operator new(std::size_t n) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+using Clock = std::chrono::steady_clock;
+
+static double ns_per_iter(Clock::time_point start, int iters) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iters;
+}
+
+int main() {
+    logger::set_level("warn");
+
+    constexpr int PLAYERS = 4;
+    constexpr int ITERS = 200000;
+
+    // Seats + lanes as a Room lays them out
+    std::vector<game::Player> seats(PLAYERS);
+    game::SimStore sim;
+    sim.resize(PLAYERS);
+    for (int i = 0; i < PLAYERS; ++i) {
+        seats[i].id = "7f1c9a2e-5b3d-4c8e-9a1f-00000000000" + std::to_string(i);
+        seats[i].slot = i;
+        sim.reset(i);
+        sim.flags[i] = game::SIM_OCCUPIED | game::SIM_CONNECTED;
+        sim.x[i] = 123.45f + 97.3f * i;
+        sim.y[i] = 601.17f;
+        sim.vx[i] = i % 2 ? -220.0f : 220.0f;
+        sim.vy[i] = -311.26f;
+        sim.state[i] = game::PlayerState::JUMPING;
+    }
+
+    // Room with the same players, mid-jump, for the tree path and Room::update
+    game::Room room("bench", PLAYERS);
+    for (const auto& p : seats) room.add_player(p);
+    room.start_game();
+
+    std::string published;
+    room.set_publish_fn([&](game::Room::Topic, const std::string& msg, bool) {
+        published.assign(msg);
+    });
+    game::PlayerInput jump;
+    jump.add_action("jump");
+    for (game::PlayerHandle player : room.players()) room.queue_input(player, 1, jump);
+    room.update(0.05f);
+
+    if (published != room.game_state().dump()) {
+        std::fprintf(stderr, "MISMATCH\nwriter: %s\ntree:   %s\n",
+                     published.c_str(), room.game_state().dump().c_str());
+        return 1;
+    }
+
+    size_t checksum = 0;
+
+    // ── nlohmann tree + dump() ─────────────────────
+    auto t0 = Clock::now();
+    for (int i = 0; i < ITERS; ++i) checksum += room.game_state().dump().size();
+    double tree_ns = ns_per_iter(t0, ITERS);
+
+    // ── Streaming writer into a reused buffer ──────
+    std::string buf;
+    network::write_game_state_json(buf, 0, 60.0f, 1, seats, sim);
+    long allocs0 = g_allocs.load();
+    t0 = Clock::now();
+    for (int i = 0; i < ITERS; ++i) {
+        buf.clear();
+        network::write_game_state_json(buf, i, 60.0f, 1, seats, sim);
+        checksum += buf.size();
+    }
+    double writer_ns = ns_per_iter(t0, ITERS);
+    long writer_allocs = g_allocs.load() - allocs0;
+
+    // ── Full Room::update (physics + encode + publish) ──
+    room.set_publish_fn([&](game::Room::Topic, const std::string& msg, bool) {
+        checksum += msg.size();
+    });
+    for (int i = 0; i < 1000; ++i) room.update(0.05f);  // let buffers reach capacity
+
+    allocs0 = g_allocs.load();
+    t0 = Clock::now();
+    for (int i = 0; i < ITERS; ++i) room.update(0.05f);
+    double update_ns = ns_per_iter(t0, ITERS);
+    long update_allocs = g_allocs.load() - allocs0;
+
+    std::printf("game_state, %d players\n", PLAYERS);
+    std::printf("  tree + dump()      %8.1f ns\n", tree_ns);
+    std::printf("  streaming writer   %8.1f ns   %ld allocs\n", writer_ns, writer_allocs);
+    std::printf("  Room::update       %8.1f ns   %.3f allocs/tick\n",
+                update_ns, static_cast<double>(update_allocs) / ITERS);
+    std::printf("  (checksum %zu)\n", checksum);
+    return update_allocs == 0 ? 0 : 2;
+}
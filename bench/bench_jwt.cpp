@@ -0,0 +1,187 @@
+// JWT verification benchmark: the original validate_jwt() (one-shot HMAC(),
+// per-character base64url decode into vectors) vs the pre-keyed HmacKey and
+// table decoder, single-threaded, in verifications per second per core.
+// Checks both accept and reject the same tokens first.
+//
+//   cmake -B build -DBUILD_BENCHMARKS=ON && cmake --build build --target bench_jwt
+//   ./build/bench_jwt
+
+#include "server/jwt.h"
+
+#include <openssl/hmac.h>
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+// ── Before: validate_jwt() as it was ────────────────
+namespace legacy {
+
+inline int b64_val(char c) {
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    if (c == '-' || c == '+') return 62;
+    if (c == '_' || c == '/') return 63;
+    return -1;
+}
+
+inline std::vector<uint8_t> base64url_decode(std::string_view input) {
+    std::vector<uint8_t> out;
+    out.reserve(input.size() * 3 / 4);
+    uint32_t buf = 0;
+    int bits = 0;
+    for (char c : input) {
+        if (c == '=' || c == ' ' || c == '\n') continue;
+        int val = b64_val(c);
+        if (val < 0) continue;
+        buf = (buf << 6) | val;
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            out.push_back(static_cast<uint8_t>((buf >> bits) & 0xFF));
+        }
+    }
+    return out;
+}
+
+inline std::optional<auth::JwtPayload> validate_jwt(const std::string& token, const std::string& secret) {
+    auto dot1 = token.find('.');
+    if (dot1 == std::string::npos) return std::nullopt;
+    auto dot2 = token.find('.', dot1 + 1);
+    if (dot2 == std::string::npos) return std::nullopt;
+
+    std::string_view payload_b64 = std::string_view(token).substr(dot1 + 1, dot2 - dot1 - 1);
+    std::string_view signature_b64 = std::string_view(token).substr(dot2 + 1);
+    std::string_view signed_part = std::string_view(token).substr(0, dot2);
+
+    unsigned char result[EVP_MAX_MD_SIZE];
+    unsigned int len = 0;
+    HMAC(EVP_sha256(), secret.data(), static_cast<int>(secret.size()),
+         reinterpret_cast<const unsigned char*>(signed_part.data()), signed_part.size(), result, &len);
+    std::vector<uint8_t> expected_sig(result, result + len);
+    auto actual_sig = base64url_decode(signature_b64);
+    if (expected_sig.size() != actual_sig.size()) return std::nullopt;
+    unsigned char diff = 0;
+    for (size_t i = 0; i < expected_sig.size(); ++i) diff |= expected_sig[i] ^ actual_sig[i];
+    if (diff != 0) return std::nullopt;
+
+    auto bytes = base64url_decode(payload_b64);
+    try {
+        auto payload = nlohmann::json::parse(std::string(bytes.begin(), bytes.end()));
+        auth::JwtPayload r;
+        r.sub = payload.value("sub", "");
+        r.username = payload.value("username", "");
+        r.exp = payload.value("exp", int64_t(0));
+        r.iat = payload.value("iat", int64_t(0));
+        if (r.sub.empty()) return std::nullopt;
+        if (r.exp > 0 && static_cast<int64_t>(std::time(nullptr)) > r.exp) return std::nullopt;
+        return r;
+    } catch (const nlohmann::json::exception&) {
+        return std::nullopt;
+    }
+}
+
+} // namespace legacy
+
+static std::string base64url(std::string_view in) {
+    static const char chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+    std::string out;
+    uint32_t buf = 0;
+    int bits = 0;
+    for (unsigned char c : in) {
+        buf = (buf << 8) | c;
+        bits += 8;
+        while (bits >= 6) {
+            bits -= 6;
+            out += chars[(buf >> bits) & 0x3F];
+        }
+    }
+    if (bits > 0) out += chars[(buf << (6 - bits)) & 0x3F];
+    return out;
+}
+
+static std::string sign(const std::string& secret, const nlohmann::json& claims) {
+    std::string signed_part = base64url(R"({"alg":"HS256","typ":"JWT"})") + "." + base64url(claims.dump());
+    unsigned char mac[EVP_MAX_MD_SIZE];
+    unsigned int len = 0;
+    HMAC(EVP_sha256(), secret.data(), static_cast<int>(secret.size()),
+         reinterpret_cast<const unsigned char*>(signed_part.data()), signed_part.size(), mac, &len);
+    return signed_part + "." + base64url(std::string_view(reinterpret_cast<char*>(mac), len));
+}
+
+template <typename Fn>
+static double verifications_per_sec(int iters, Fn&& fn) {
+    auto t0 = Clock::now();
+    for (int i = 0; i < iters; ++i) fn();
+    return iters / std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+int main() {
+    logger::set_level("error");
+
+    const std::string secret = "0c5e1d7f3a9b4e2c8f6a1d3b5e7c9a2f";
+    const std::string long_secret(100, 'k');  // longer than the SHA-256 block
+    auto now = static_cast<int64_t>(std::time(nullptr));
+    nlohmann::json claims = {
+        {"sub", "7f1c9a2e-5b3d-4c8e-9a1f-000000000001"},
+        {"username", "player_one"},
+        {"iat", now},
+        {"exp", now + 3600}
+    };
+    const std::string token = sign(secret, claims);
+
+    // ── Same verdicts ───────────────────────────────
+    std::string tampered_payload = token;
+    tampered_payload[token.find('.') + 5] ^= 1;
+    std::string tampered_sig = token;
+    tampered_sig[token.size() - 2] = tampered_sig[token.size() - 2] == 'A' ? 'B' : 'A';
+    nlohmann::json expired = claims;
+    expired["exp"] = now - 10;
+    nlohmann::json no_sub = claims;
+    no_sub.erase("sub");
+
+    struct Case {
+        const char* name;
+        std::string token;
+        const std::string* secret;
+    };
+    const Case cases[] = {
+        {"valid", token, &secret},
+        {"valid, long secret", sign(long_secret, claims), &long_secret},
+        {"wrong secret", sign("other", claims), &secret},
+        {"tampered payload", tampered_payload, &secret},
+        {"tampered signature", tampered_sig, &secret},
+        {"truncated signature", token.substr(0, token.size() - 4), &secret},
+        {"expired", sign(secret, expired), &secret},
+        {"no sub", sign(secret, no_sub), &secret},
+        {"no dots", "abc", &secret},
+        {"garbage payload", base64url("{}") + ".!!!!." + token.substr(token.rfind('.') + 1), &secret},
+    };
+    int status = 0;
+    for (const auto& c : cases) {
+        auto before = legacy::validate_jwt(c.token, *c.secret);
+        auto after = auth::validate_jwt(c.token, auth::HmacKey(*c.secret));
+        bool same = before.has_value() == after.has_value() && (!before || before->sub == after->sub);
+        if (!same) status = 1;
+        std::printf("  %-20s %-7s %s\n", c.name, after ? "accept" : "reject", same ? "" : "MISMATCH");
+    }
+
+    // ── Throughput ──────────────────────────────────
+    constexpr int ITERS = 200000;
+    size_t accepted = 0;
+    double before = verifications_per_sec(ITERS, [&] { accepted += legacy::validate_jwt(token, secret).has_value(); });
+    double per_call = verifications_per_sec(ITERS, [&] { accepted += auth::validate_jwt(token, secret).has_value(); });
+    const auth::HmacKey key(secret);
+    double after = verifications_per_sec(ITERS, [&] { accepted += auth::validate_jwt(token, key).has_value(); });
+
+    std::printf("validate_jwt, %zu-byte token, one core\n", token.size());
+    std::printf("  before (HMAC(), vector decode)   %9.0f /s\n", before);
+    std::printf("  table decode, keyed per call     %9.0f /s   x%.2f\n", per_call, per_call / before);
+    std::printf("  table decode, pre-keyed HmacKey  %9.0f /s   x%.2f\n", after, after / before);
+    std::printf("  (accepted %zu)\n", accepted);
+    return accepted == 3 * ITERS ? status : 2;
+}
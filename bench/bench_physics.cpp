@@ -0,0 +1,157 @@
+// Batched physics benchmark: scalar vs SSE4.1 vs AVX2 physics::step() over
+// one world of N player lanes, the way WebSocketServer::tick() steps every
+// playing room at once. Checks every vector kernel leaves the store
+// bit-identical to the scalar kernel before timing anything.
+//
+//   cmake -B build -DBUILD_BENCHMARKS=ON && cmake --build build --target bench_physics
+//   ./build/bench_physics
+
+#include "game/sim_store.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+using game::physics::Kernel;
+
+constexpr float DT = 0.05f;
+
+// A world of `n` lanes with a realistic mix: mostly connected players in
+// playing rooms, some disconnected seats, waiting rooms, free lanes and
+// dead players, spread over the air and the ground.
+static game::SimStore make_world(size_t n, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> ux(-20.0f, game::physics::MAP_WIDTH + 20.0f);
+    std::uniform_real_distribution<float> uy(300.0f, game::physics::GROUND_Y + 5.0f);
+    std::uniform_real_distribution<float> uv(-500.0f, 500.0f);
+    std::uniform_int_distribution<int> pct(0, 99);
+
+    game::SimStore s;
+    s.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        s.reset(i);
+        int kind = pct(rng);
+        if (kind < 80)      s.flags[i] = game::SIM_OCCUPIED | game::SIM_CONNECTED | game::SIM_ACTIVE;
+        else if (kind < 85) s.flags[i] = game::SIM_OCCUPIED | game::SIM_ACTIVE;     // disconnected
+        else if (kind < 95) s.flags[i] = game::SIM_OCCUPIED | game::SIM_CONNECTED;  // lobby
+        else                s.flags[i] = 0;                                          // free
+
+        s.x[i] = ux(rng);
+        s.y[i] = pct(rng) < 50 ? game::physics::GROUND_Y : uy(rng);
+        s.vx[i] = uv(rng);
+        s.vy[i] = uv(rng);
+        if (pct(rng) < 2) s.health[i] = 0;
+    }
+
+    // Edge cases the selects must get exactly right
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const float specials[][2] = {
+        {-0.0f, game::physics::GROUND_Y}, {nan, 500.0f}, {500.0f, nan},
+        {0.0f, game::physics::GROUND_Y - 0.1f}, {game::physics::MAP_WIDTH, game::physics::GROUND_Y + 50.0f},
+    };
+    for (size_t k = 0; k < std::size(specials) && k < n; ++k) {
+        s.flags[k] = game::SIM_OCCUPIED | game::SIM_CONNECTED | game::SIM_ACTIVE;
+        s.x[k] = specials[k][0];
+        s.y[k] = specials[k][1];
+    }
+    return s;
+}
+
+// One tick's worth of inputs for every lane
+static void feed_inputs(game::SimStore& s, std::mt19937& rng) {
+    std::uniform_int_distribution<int> pct(0, 99);
+    std::uniform_int_distribution<int> axis(-127, 127);
+    for (size_t i = 0; i < s.size(); ++i) {
+        game::PlayerInput in;
+        int r = pct(rng);
+        if (r < 25)      in.add_action("left");
+        else if (r < 50) in.add_action("right");
+        if (pct(rng) < 15) in.add_action("jump");
+        if (pct(rng) < 20) in.move_x = static_cast<int8_t>(axis(rng));
+        s.set_input(i, in);
+    }
+}
+
+template <typename T>
+static bool same_bits(const std::vector<T>& a, const std::vector<T>& b) {
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0;
+}
+
+static bool identical(const game::SimStore& a, const game::SimStore& b) {
+    return same_bits(a.x, b.x) && same_bits(a.y, b.y) && same_bits(a.vx, b.vx) && same_bits(a.vy, b.vy)
+        && same_bits(a.health, b.health) && same_bits(a.input, b.input) && same_bits(a.move_x, b.move_x)
+        && same_bits(a.state, b.state) && same_bits(a.facing, b.facing) && same_bits(a.flags, b.flags);
+}
+
+int main() {
+    const Kernel kernels[] = {Kernel::SCALAR, Kernel::SSE41, Kernel::AVX2};
+    const size_t sizes[] = {1000, 10000, 100000};
+    int status = 0;
+
+    std::printf("physics::step, dt=%.2f (default kernel: %s)\n", DT,
+                std::string(game::physics::kernel_name(game::physics::kernel())).c_str());
+
+    for (size_t n : sizes) {
+        // ── Bit-identical check over 200 ticks ──────
+        // Odd bounds exercise the scalar tail of the vector kernels
+        const game::SimStore initial = make_world(n + 3, 1234);
+        game::SimStore reference = initial;
+        std::vector<game::SimStore> candidates;
+        for (size_t k = 0; k < std::size(kernels); ++k) candidates.push_back(initial);
+
+        std::mt19937 check_rng(99);
+        for (int t = 0; t < 200; ++t) {
+            feed_inputs(reference, check_rng);
+            for (auto& c : candidates) {
+                c.input = reference.input;
+                c.move_x = reference.move_x;
+            }
+            game::physics::step_with(Kernel::SCALAR, reference, 1, n + 2, DT);
+            for (size_t k = 0; k < std::size(kernels); ++k) {
+                if (!game::physics::kernel_supported(kernels[k])) continue;
+                game::physics::step_with(kernels[k], candidates[k], 1, n + 2, DT);
+            }
+        }
+
+        // ── Timing ──────────────────────────────────
+        const int iters = n >= 100000 ? 200 : n >= 10000 ? 2000 : 20000;
+        double scalar_ns = 0;
+
+        std::printf("  %zu players\n", n);
+        for (size_t k = 0; k < std::size(kernels); ++k) {
+            std::string name(game::physics::kernel_name(kernels[k]));
+            if (!game::physics::kernel_supported(kernels[k])) {
+                std::printf("    %-8s  not supported on this CPU\n", name.c_str());
+                continue;
+            }
+            bool ok = identical(reference, candidates[k]);
+            if (!ok) status = 1;
+
+            game::SimStore world = make_world(n, 1234);
+            std::mt19937 rng(7);
+            feed_inputs(world, rng);
+            const auto inputs = world.input;
+            const auto axes = world.move_x;
+
+            double total_ns = 0;
+            for (int i = 0; i < iters; ++i) {
+                std::memcpy(world.input.data(), inputs.data(), n);
+                std::memcpy(world.move_x.data(), axes.data(), n);
+                auto t0 = Clock::now();
+                game::physics::step_with(kernels[k], world, 0, n, DT);
+                total_ns += std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+            }
+            double ns = total_ns / iters;
+            if (kernels[k] == Kernel::SCALAR) scalar_ns = ns;
+
+            std::printf("    %-8s %10.1f ns/step  %6.2f ns/player  x%.2f  %s\n",
+                        name.c_str(), ns, ns / n, scalar_ns / ns,
+                        ok ? "bit-identical" : "MISMATCH");
+        }
+    }
+    return status;
+}
@@ -0,0 +1,161 @@
+// Simulation pool benchmark: wall time of one shard tick (physics, snapshot
+// encoding, then sends) over N rooms of 4 players, ticked on the loop alone
+// and on a utils::WorkPool of 1..16 participants, the way
+// WebSocketServer::tick() runs it with SIM_WORKERS. Checks every
+// configuration sends exactly the same bytes.
+//
+//   cmake -B build -DBUILD_BENCHMARKS=ON && cmake --build build --target bench_sim_pool
+//   ./build/bench_sim_pool
+
+#include "game/room.h"
+#include "utils/logger.h"
+#include "utils/work_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+constexpr float DT = 0.05f;
+constexpr int PLAYERS = 4;
+constexpr size_t CHUNK_LANES = 1024;  // WebSocketServer::SIM_CHUNK_LANES
+
+// One shard's rooms in a shared world. Each room has a JSON player, a
+// binary player and two delta players that ack every frame.
+struct Shard {
+    game::SimWorld world;
+    std::vector<std::unique_ptr<game::Room>> rooms;
+    std::vector<game::Room*> stepped;
+    std::vector<std::vector<game::PlayerHandle>> players;  // per room, in slot order
+    size_t bytes = 0;
+    uint64_t hash = 1469598103934665603ull;
+
+    explicit Shard(size_t room_count) {
+        const network::WireFormat formats[PLAYERS] = {
+            network::WireFormat::JSON, network::WireFormat::BINARY,
+            network::WireFormat::BINARY_DELTA, network::WireFormat::BINARY_DELTA,
+        };
+        for (size_t r = 0; r < room_count; ++r) {
+            auto room = std::make_unique<game::Room>("r" + std::to_string(r), PLAYERS, &world);
+            for (int i = 0; i < PLAYERS; ++i) {
+                game::Player p;
+                p.id = "r" + std::to_string(r) + "-p" + std::to_string(i);
+                p.wire_format = formats[i];
+                room->add_player(p);
+            }
+            room->start_game();
+            players.push_back(room->players());
+
+            game::Room* raw = room.get();
+            room->set_publish_fn([this](game::Room::Topic, const std::string& msg, bool) {
+                count(msg);
+            });
+            room->set_broadcast_fn([this, raw](game::PlayerHandle player, const std::string& msg, bool) {
+                count(msg);
+                raw->ack_snapshot(player, raw->current_tick());
+            });
+            rooms.push_back(std::move(room));
+        }
+    }
+
+    void count(const std::string& msg) {
+        bytes += msg.size();
+        for (unsigned char c : msg) {
+            hash ^= c;
+            hash *= 1099511628211ull;
+        }
+    }
+
+    // Inputs vary by room and tick so rooms don't all move alike
+    void feed_inputs(int t) {
+        for (size_t r = 0; r < rooms.size(); ++r) {
+            int tick = rooms[r]->current_tick() + 1;
+            for (int i = 0; i < PLAYERS; ++i) {
+                game::PlayerInput in;
+                int k = static_cast<int>((r * 7 + i * 3 + t) % 10);
+                if (k < 4) in.add_action("left");
+                else if (k < 8) in.add_action("right");
+                if (k == 0 || k == 5) in.add_action("jump");
+                rooms[r]->queue_input(players[r][i], tick, in);
+            }
+        }
+    }
+
+    // WebSocketServer::tick(), minus the bookkeeping
+    void tick(utils::WorkPool* pool) {
+        stepped.clear();
+        for (auto& room : rooms) {
+            if (room->begin_update()) stepped.push_back(room.get());
+        }
+        if (pool) {
+            auto& lanes = world.lanes;
+            size_t chunks = (lanes.size() + CHUNK_LANES - 1) / CHUNK_LANES;
+            pool->parallel_for(chunks, [&](size_t c) {
+                size_t begin = c * CHUNK_LANES;
+                game::physics::step(lanes, begin, std::min(lanes.size(), begin + CHUNK_LANES), DT);
+            });
+            pool->parallel_for(stepped.size(), [&](size_t i) { stepped[i]->encode_game_state(); });
+        } else {
+            game::physics::step(world.lanes, DT);
+            for (auto* room : stepped) room->encode_game_state();
+        }
+        for (auto* room : stepped) room->send_game_state();
+    }
+};
+
+int main() {
+    logger::set_level("warn");
+
+    const size_t room_counts[] = {64, 256, 1024, 4096};
+    // Participants including the ticking thread; 0 = the loop on its own, no pool
+    const int participants[] = {0, 1, 2, 4, 8, 16};
+    constexpr int WARMUP = 50;
+    constexpr int TICKS = 200;
+    int status = 0;
+
+    std::printf("shard tick, %d players/room, %d ticks (%u hardware threads)\n",
+                PLAYERS, TICKS, std::thread::hardware_concurrency());
+
+    for (size_t rooms : room_counts) {
+        std::printf("  %zu rooms\n", rooms);
+        double loop_us = 0;
+        uint64_t loop_hash = 0;
+
+        for (int p : participants) {
+            auto pool = p > 0 ? std::make_unique<utils::WorkPool>(p - 1) : nullptr;
+            Shard shard(rooms);
+
+            int t = 0;
+            for (; t < WARMUP; ++t) {
+                shard.feed_inputs(t);
+                shard.tick(pool.get());
+            }
+            double total_us = 0;
+            for (; t < WARMUP + TICKS; ++t) {
+                shard.feed_inputs(t);
+                auto t0 = Clock::now();
+                shard.tick(pool.get());
+                total_us += std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+            }
+            double us = total_us / TICKS;
+
+            if (p == 0) {
+                loop_us = us;
+                loop_hash = shard.hash;
+            }
+            bool same = shard.hash == loop_hash;
+            if (!same) status = 1;
+
+            std::string label = p == 0 ? "loop" : "pool x" + std::to_string(p);
+            std::printf("    %-8s %10.1f us/tick  %6.3f us/room  x%.2f  %8.1f KB/tick  %s\n",
+                        label.c_str(), us, us / rooms, loop_us / us,
+                        shard.bytes / 1024.0 / (WARMUP + TICKS), same ? "same bytes" : "MISMATCH");
+        }
+    }
+    return status;
+}
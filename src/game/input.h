@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string_view>
+#include <array>
+#include <utility>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+namespace game {
+
+// ── Player input ────────────────────────────────────
+// The protocol layer folds each player_input message into a PlayerInput
+// once; the physics step only ever tests bits. The JSON action names in
+// ACTION_NAMES stay the external vocabulary.
+
+using ActionMask = uint8_t;
+
+namespace action {
+    constexpr ActionMask LEFT  = 1 << 0;
+    constexpr ActionMask RIGHT = 1 << 1;
+    constexpr ActionMask JUMP  = 1 << 2;
+}
+
+constexpr std::array<std::pair<std::string_view, ActionMask>, 3> ACTION_NAMES = {{
+    {"left",  action::LEFT},
+    {"right", action::RIGHT},
+    {"jump",  action::JUMP},
+}};
+
+struct PlayerInput {
+    ActionMask actions = 0;
+    int8_t move_x = 0;   // optional analog stick, -127..127; digital left/right win
+
+    // Fold one action name in. Unknown names are ignored. Left and right are
+    // exclusive and the later one wins, matching message order.
+    void add_action(std::string_view name) {
+        for (const auto& [n, bit] : ACTION_NAMES) {
+            if (n != name) continue;
+            if (bit == action::LEFT)  actions &= ~action::RIGHT;
+            if (bit == action::RIGHT) actions &= ~action::LEFT;
+            actions |= bit;
+            return;
+        }
+    }
+
+    // Analog horizontal axis in [-1, 1]
+    void set_move_x(float axis) {
+        if (!std::isfinite(axis)) return;
+        move_x = static_cast<int8_t>(std::lround(std::clamp(axis, -1.0f, 1.0f) * 127.0f));
+    }
+
+    bool has(ActionMask bit) const { return (actions & bit) != 0; }
+};
+
+} // namespace game
@@ -0,0 +1,435 @@
+#include "game/sim_store.h"
+
+#include <cstring>
+
+#if defined(__x86_64__)
+#define PHYSICS_X86 1
+#include <immintrin.h>
+#endif
+
+// Built with -ffp-contract=off (see CMakeLists.txt): the scalar loop must not
+// be fused into FMAs, or it would stop matching the vector kernels bit for bit.
+
+namespace game::physics {
+
+namespace {
+
+constexpr uint8_t STEPPED = SIM_CONNECTED | SIM_ACTIVE;
+constexpr float ON_GROUND_Y = GROUND_Y - 0.1f;  // same threshold as SimStore::on_ground
+
+// ── Scalar kernel (reference) ───────────────────────
+
+void step_scalar(SimStore& s, size_t begin, size_t end, float dt) {
+    for (size_t i = begin; i < end; ++i) {
+        if ((s.flags[i] & STEPPED) != STEPPED) continue;
+
+        if (s.health[i] <= 0) {
+            s.state[i] = PlayerState::DEAD;
+            s.vx[i] = 0;
+            continue;
+        }
+
+        const ActionMask in = s.input[i];
+        float vx = 0;
+        float vy = s.vy[i];
+
+        if (in & action::LEFT) {
+            vx = -MOVE_SPEED;
+            s.facing[i] = Facing::LEFT;
+        } else if (in & action::RIGHT) {
+            vx = MOVE_SPEED;
+            s.facing[i] = Facing::RIGHT;
+        } else if (s.move_x[i] != 0) {
+            vx = MOVE_SPEED * (s.move_x[i] / 127.0f);
+            s.facing[i] = s.move_x[i] < 0 ? Facing::LEFT : Facing::RIGHT;
+        }
+        if ((in & action::JUMP) && s.on_ground(i)) {
+            vy = JUMP_VELOCITY;
+        }
+
+        // Gravity
+        vy += GRAVITY * dt;
+
+        // Integrate position
+        float x = s.x[i] + vx * dt;
+        float y = s.y[i] + vy * dt;
+
+        // Ground collision
+        if (y >= GROUND_Y) {
+            y = GROUND_Y;
+            vy = 0;
+        }
+
+        // Clamp to map bounds
+        x = std::clamp(x, 0.0f, MAP_WIDTH);
+
+        s.x[i] = x;
+        s.y[i] = y;
+        s.vx[i] = vx;
+        s.vy[i] = vy;
+
+        // Update visual state
+        if (!s.on_ground(i)) {
+            s.state[i] = vy < 0 ? PlayerState::JUMPING : PlayerState::FALLING;
+        } else if (std::abs(vx) > 0.1f) {
+            s.state[i] = PlayerState::RUNNING;
+        } else {
+            s.state[i] = PlayerState::IDLE;
+        }
+
+        // Clear inputs after processing
+        s.input[i] = 0;
+        s.move_x[i] = 0;
+    }
+}
+
+#ifdef PHYSICS_X86
+
+// ── Vector kernels ──────────────────────────────────
+// Same per-lane logic as step_scalar, with every branch turned into a
+// select. Byte lanes (flags, input, move_x, state, facing) are widened to
+// 32 bits, and lanes that aren't stepped are written back unchanged. The
+// tail that doesn't fill a vector goes through step_scalar.
+
+constexpr int32_t STATE_RUNNING = static_cast<int32_t>(PlayerState::RUNNING);
+constexpr int32_t STATE_JUMPING = static_cast<int32_t>(PlayerState::JUMPING);
+constexpr int32_t STATE_FALLING = static_cast<int32_t>(PlayerState::FALLING);
+constexpr int32_t STATE_DEAD    = static_cast<int32_t>(PlayerState::DEAD);
+constexpr int32_t FACING_LEFT   = static_cast<int32_t>(Facing::LEFT);
+
+template <typename T>
+inline uint32_t load4(const T* p) {
+    static_assert(sizeof(T) == 1);
+    uint32_t v;
+    std::memcpy(&v, p, 4);
+    return v;
+}
+
+template <typename T>
+inline uint64_t load8(const T* p) {
+    static_assert(sizeof(T) == 1);
+    uint64_t v;
+    std::memcpy(&v, p, 8);
+    return v;
+}
+
+// 4 lanes: bytes ↔ 32-bit lanes, bit tests
+__attribute__((target("sse4.1")))
+inline __m128i widen4_u8(uint32_t bytes) { return _mm_cvtepu8_epi32(_mm_cvtsi32_si128(static_cast<int>(bytes))); }
+
+__attribute__((target("sse4.1")))
+inline __m128i widen4_i8(uint32_t bytes) { return _mm_cvtepi8_epi32(_mm_cvtsi32_si128(static_cast<int>(bytes))); }
+
+__attribute__((target("sse4.1")))
+inline void store4_u8(void* dst, __m128i v) {
+    const __m128i low_bytes = _mm_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    uint32_t bytes = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_shuffle_epi8(v, low_bytes)));
+    std::memcpy(dst, &bytes, 4);
+}
+
+__attribute__((target("sse4.1")))
+inline __m128i has4(__m128i v, __m128i bit) { return _mm_cmpeq_epi32(_mm_and_si128(v, bit), bit); }
+
+// 8 lanes
+__attribute__((target("avx2")))
+inline __m256i widen8_u8(uint64_t bytes) { return _mm256_cvtepu8_epi32(_mm_cvtsi64_si128(static_cast<long long>(bytes))); }
+
+__attribute__((target("avx2")))
+inline __m256i widen8_i8(uint64_t bytes) { return _mm256_cvtepi8_epi32(_mm_cvtsi64_si128(static_cast<long long>(bytes))); }
+
+__attribute__((target("avx2")))
+inline void store8_u8(void* dst, __m256i v) {
+    // Low byte of each 32-bit lane → first dword of each 128-bit half,
+    // then the two halves' first dwords side by side
+    const __m256i low_bytes = _mm256_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                               0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    __m256i packed = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(v, low_bytes),
+                                                  _mm256_setr_epi32(0, 4, 0, 0, 0, 0, 0, 0));
+    uint64_t bytes = static_cast<uint64_t>(_mm_cvtsi128_si64(_mm256_castsi256_si128(packed)));
+    std::memcpy(dst, &bytes, 8);
+}
+
+__attribute__((target("avx2")))
+inline __m256i has8(__m256i v, __m256i bit) { return _mm256_cmpeq_epi32(_mm256_and_si256(v, bit), bit); }
+
+__attribute__((target("sse4.1")))
+void step_sse41(SimStore& s, size_t begin, size_t end, float dt) {
+    const __m128 v_dt      = _mm_set1_ps(dt);
+    const __m128 v_g_dt    = _mm_set1_ps(GRAVITY * dt);
+    const __m128 v_speed   = _mm_set1_ps(MOVE_SPEED);
+    const __m128 v_nspeed  = _mm_set1_ps(-MOVE_SPEED);
+    const __m128 v_jump    = _mm_set1_ps(JUMP_VELOCITY);
+    const __m128 v_ground  = _mm_set1_ps(GROUND_Y);
+    const __m128 v_on_gnd  = _mm_set1_ps(ON_GROUND_Y);
+    const __m128 v_width   = _mm_set1_ps(MAP_WIDTH);
+    const __m128 v_127     = _mm_set1_ps(127.0f);
+    const __m128 v_run     = _mm_set1_ps(0.1f);
+    const __m128 v_zero    = _mm_setzero_ps();
+    const __m128 v_sign    = _mm_set1_ps(-0.0f);
+    const __m128i i_zero    = _mm_setzero_si128();
+    const __m128i i_one     = _mm_set1_epi32(1);
+    const __m128i i_stepped = _mm_set1_epi32(STEPPED);
+    const __m128i i_left    = _mm_set1_epi32(action::LEFT);
+    const __m128i i_right   = _mm_set1_epi32(action::RIGHT);
+    const __m128i i_jump    = _mm_set1_epi32(action::JUMP);
+
+
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128i flags = widen4_u8(load4(&s.flags[i]));
+        __m128i stepped = has4(flags, i_stepped);
+        if (_mm_testz_si128(stepped, stepped)) continue;
+
+        __m128i health = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&s.health[i]));
+        __m128i dead = _mm_and_si128(stepped, _mm_cmpgt_epi32(i_one, health));
+        __m128i live = _mm_andnot_si128(dead, stepped);
+        __m128 live_f = _mm_castsi128_ps(live);
+
+        __m128i in     = widen4_u8(load4(&s.input[i]));
+        __m128i mx     = widen4_i8(load4(&s.move_x[i]));
+        __m128i state  = widen4_u8(load4(&s.state[i]));
+        __m128i facing = widen4_u8(load4(&s.facing[i]));
+        __m128 x0  = _mm_loadu_ps(&s.x[i]);
+        __m128 y0  = _mm_loadu_ps(&s.y[i]);
+        __m128 vx0 = _mm_loadu_ps(&s.vx[i]);
+        __m128 vy0 = _mm_loadu_ps(&s.vy[i]);
+
+        // Horizontal: left, else right, else analog axis, else stop
+        __m128i left   = has4(in, i_left);
+        __m128i right  = _mm_andnot_si128(left, has4(in, i_right));
+        __m128i mx_neg = _mm_cmpgt_epi32(i_zero, mx);
+        __m128i analog = _mm_andnot_si128(_mm_or_si128(_mm_or_si128(left, right),
+                                                       _mm_cmpeq_epi32(mx, i_zero)),
+                                          _mm_cmpeq_epi32(i_zero, i_zero));
+
+        __m128 vx = _mm_mul_ps(v_speed, _mm_div_ps(_mm_cvtepi32_ps(mx), v_127));
+        vx = _mm_blendv_ps(v_zero, vx, _mm_castsi128_ps(analog));
+        vx = _mm_blendv_ps(vx, v_speed, _mm_castsi128_ps(right));
+        vx = _mm_blendv_ps(vx, v_nspeed, _mm_castsi128_ps(left));
+
+        __m128i new_facing = _mm_blendv_epi8(facing, _mm_and_si128(mx_neg, i_one), analog);
+        new_facing = _mm_blendv_epi8(new_facing, i_zero, right);
+        new_facing = _mm_blendv_epi8(new_facing, _mm_set1_epi32(FACING_LEFT), left);
+
+        // Jump only from the ground
+        __m128i jump = _mm_and_si128(has4(in, i_jump),
+                                     _mm_castps_si128(_mm_cmpge_ps(y0, v_on_gnd)));
+        __m128 vy = _mm_blendv_ps(vy0, v_jump, _mm_castsi128_ps(jump));
+
+        // Gravity, integrate, ground collision, map bounds
+        vy = _mm_add_ps(vy, v_g_dt);
+        __m128 x = _mm_add_ps(x0, _mm_mul_ps(vx, v_dt));
+        __m128 y = _mm_add_ps(y0, _mm_mul_ps(vy, v_dt));
+
+        __m128 grounded = _mm_cmpge_ps(y, v_ground);
+        y  = _mm_blendv_ps(y, v_ground, grounded);
+        vy = _mm_blendv_ps(vy, v_zero, grounded);
+
+        x = _mm_blendv_ps(x, v_zero, _mm_cmplt_ps(x, v_zero));
+        x = _mm_blendv_ps(x, v_width, _mm_cmplt_ps(v_width, x));
+
+        // Visual state
+        __m128i air_state = _mm_blendv_epi8(_mm_set1_epi32(STATE_FALLING), _mm_set1_epi32(STATE_JUMPING),
+                                            _mm_castps_si128(_mm_cmplt_ps(vy, v_zero)));
+        __m128i gnd_state = _mm_and_si128(_mm_castps_si128(_mm_cmpgt_ps(_mm_andnot_ps(v_sign, vx), v_run)),
+                                          _mm_set1_epi32(STATE_RUNNING));
+        __m128i new_state = _mm_blendv_epi8(air_state, gnd_state,
+                                            _mm_castps_si128(_mm_cmpge_ps(y, v_on_gnd)));
+
+        // Write back: live lanes get the step, dead lanes stop, others keep
+        _mm_storeu_ps(&s.x[i], _mm_blendv_ps(x0, x, live_f));
+        _mm_storeu_ps(&s.y[i], _mm_blendv_ps(y0, y, live_f));
+        _mm_storeu_ps(&s.vy[i], _mm_blendv_ps(vy0, vy, live_f));
+        vx = _mm_blendv_ps(vx0, vx, live_f);
+        _mm_storeu_ps(&s.vx[i], _mm_blendv_ps(vx, v_zero, _mm_castsi128_ps(dead)));
+
+        state = _mm_blendv_epi8(state, new_state, live);
+        store4_u8(&s.state[i], _mm_blendv_epi8(state, _mm_set1_epi32(STATE_DEAD), dead));
+        store4_u8(&s.facing[i], _mm_blendv_epi8(facing, new_facing, live));
+        store4_u8(&s.input[i], _mm_andnot_si128(live, in));
+        store4_u8(&s.move_x[i], _mm_andnot_si128(live, mx));
+    }
+    step_scalar(s, i, end, dt);
+}
+
+__attribute__((target("avx2")))
+void step_avx2(SimStore& s, size_t begin, size_t end, float dt) {
+    const __m256 v_dt      = _mm256_set1_ps(dt);
+    const __m256 v_g_dt    = _mm256_set1_ps(GRAVITY * dt);
+    const __m256 v_speed   = _mm256_set1_ps(MOVE_SPEED);
+    const __m256 v_nspeed  = _mm256_set1_ps(-MOVE_SPEED);
+    const __m256 v_jump    = _mm256_set1_ps(JUMP_VELOCITY);
+    const __m256 v_ground  = _mm256_set1_ps(GROUND_Y);
+    const __m256 v_on_gnd  = _mm256_set1_ps(ON_GROUND_Y);
+    const __m256 v_width   = _mm256_set1_ps(MAP_WIDTH);
+    const __m256 v_127     = _mm256_set1_ps(127.0f);
+    const __m256 v_run     = _mm256_set1_ps(0.1f);
+    const __m256 v_zero    = _mm256_setzero_ps();
+    const __m256 v_sign    = _mm256_set1_ps(-0.0f);
+    const __m256i i_zero    = _mm256_setzero_si256();
+    const __m256i i_one     = _mm256_set1_epi32(1);
+    const __m256i i_stepped = _mm256_set1_epi32(STEPPED);
+    const __m256i i_left    = _mm256_set1_epi32(action::LEFT);
+    const __m256i i_right   = _mm256_set1_epi32(action::RIGHT);
+    const __m256i i_jump    = _mm256_set1_epi32(action::JUMP);
+
+
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256i flags = widen8_u8(load8(&s.flags[i]));
+        __m256i stepped = has8(flags, i_stepped);
+        if (_mm256_testz_si256(stepped, stepped)) continue;
+
+        __m256i health = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&s.health[i]));
+        __m256i dead = _mm256_and_si256(stepped, _mm256_cmpgt_epi32(i_one, health));
+        __m256i live = _mm256_andnot_si256(dead, stepped);
+        __m256 live_f = _mm256_castsi256_ps(live);
+
+        __m256i in     = widen8_u8(load8(&s.input[i]));
+        __m256i mx     = widen8_i8(load8(&s.move_x[i]));
+        __m256i state  = widen8_u8(load8(&s.state[i]));
+        __m256i facing = widen8_u8(load8(&s.facing[i]));
+        __m256 x0  = _mm256_loadu_ps(&s.x[i]);
+        __m256 y0  = _mm256_loadu_ps(&s.y[i]);
+        __m256 vx0 = _mm256_loadu_ps(&s.vx[i]);
+        __m256 vy0 = _mm256_loadu_ps(&s.vy[i]);
+
+        // Horizontal: left, else right, else analog axis, else stop
+        __m256i left   = has8(in, i_left);
+        __m256i right  = _mm256_andnot_si256(left, has8(in, i_right));
+        __m256i mx_neg = _mm256_cmpgt_epi32(i_zero, mx);
+        __m256i analog = _mm256_andnot_si256(_mm256_or_si256(_mm256_or_si256(left, right),
+                                                             _mm256_cmpeq_epi32(mx, i_zero)),
+                                             _mm256_cmpeq_epi32(i_zero, i_zero));
+
+        __m256 vx = _mm256_mul_ps(v_speed, _mm256_div_ps(_mm256_cvtepi32_ps(mx), v_127));
+        vx = _mm256_blendv_ps(v_zero, vx, _mm256_castsi256_ps(analog));
+        vx = _mm256_blendv_ps(vx, v_speed, _mm256_castsi256_ps(right));
+        vx = _mm256_blendv_ps(vx, v_nspeed, _mm256_castsi256_ps(left));
+
+        __m256i new_facing = _mm256_blendv_epi8(facing, _mm256_and_si256(mx_neg, i_one), analog);
+        new_facing = _mm256_blendv_epi8(new_facing, i_zero, right);
+        new_facing = _mm256_blendv_epi8(new_facing, _mm256_set1_epi32(FACING_LEFT), left);
+
+        // Jump only from the ground
+        __m256i jump = _mm256_and_si256(has8(in, i_jump),
+                                        _mm256_castps_si256(_mm256_cmp_ps(y0, v_on_gnd, _CMP_GE_OQ)));
+        __m256 vy = _mm256_blendv_ps(vy0, v_jump, _mm256_castsi256_ps(jump));
+
+        // Gravity, integrate, ground collision, map bounds
+        vy = _mm256_add_ps(vy, v_g_dt);
+        __m256 x = _mm256_add_ps(x0, _mm256_mul_ps(vx, v_dt));
+        __m256 y = _mm256_add_ps(y0, _mm256_mul_ps(vy, v_dt));
+
+        __m256 grounded = _mm256_cmp_ps(y, v_ground, _CMP_GE_OQ);
+        y  = _mm256_blendv_ps(y, v_ground, grounded);
+        vy = _mm256_blendv_ps(vy, v_zero, grounded);
+
+        x = _mm256_blendv_ps(x, v_zero, _mm256_cmp_ps(x, v_zero, _CMP_LT_OQ));
+        x = _mm256_blendv_ps(x, v_width, _mm256_cmp_ps(v_width, x, _CMP_LT_OQ));
+
+        // Visual state
+        __m256i air_state = _mm256_blendv_epi8(_mm256_set1_epi32(STATE_FALLING), _mm256_set1_epi32(STATE_JUMPING),
+                                               _mm256_castps_si256(_mm256_cmp_ps(vy, v_zero, _CMP_LT_OQ)));
+        __m256i gnd_state = _mm256_and_si256(
+            _mm256_castps_si256(_mm256_cmp_ps(_mm256_andnot_ps(v_sign, vx), v_run, _CMP_GT_OQ)),
+            _mm256_set1_epi32(STATE_RUNNING));
+        __m256i new_state = _mm256_blendv_epi8(air_state, gnd_state,
+                                               _mm256_castps_si256(_mm256_cmp_ps(y, v_on_gnd, _CMP_GE_OQ)));
+
+        // Write back: live lanes get the step, dead lanes stop, others keep
+        _mm256_storeu_ps(&s.x[i], _mm256_blendv_ps(x0, x, live_f));
+        _mm256_storeu_ps(&s.y[i], _mm256_blendv_ps(y0, y, live_f));
+        _mm256_storeu_ps(&s.vy[i], _mm256_blendv_ps(vy0, vy, live_f));
+        vx = _mm256_blendv_ps(vx0, vx, live_f);
+        _mm256_storeu_ps(&s.vx[i], _mm256_blendv_ps(vx, v_zero, _mm256_castsi256_ps(dead)));
+
+        state = _mm256_blendv_epi8(state, new_state, live);
+        store8_u8(&s.state[i], _mm256_blendv_epi8(state, _mm256_set1_epi32(STATE_DEAD), dead));
+        store8_u8(&s.facing[i], _mm256_blendv_epi8(facing, new_facing, live));
+        store8_u8(&s.input[i], _mm256_andnot_si256(live, in));
+        store8_u8(&s.move_x[i], _mm256_andnot_si256(live, mx));
+    }
+    step_scalar(s, i, end, dt);
+}
+
+#endif // PHYSICS_X86
+
+Kernel g_kernel = best_kernel();
+
+} // namespace
+
+// ── Kernel selection ────────────────────────────────
+
+std::string_view kernel_name(Kernel k) {
+    switch (k) {
+        case Kernel::SCALAR: return "scalar";
+        case Kernel::SSE41:  return "sse4.1";
+        case Kernel::AVX2:   return "avx2";
+    }
+    return "unknown";
+}
+
+bool kernel_supported(Kernel k) {
+    switch (k) {
+        case Kernel::SCALAR: return true;
+#ifdef PHYSICS_X86
+        case Kernel::SSE41:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("sse4.1");
+        case Kernel::AVX2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+#else
+        default: return false;
+#endif
+    }
+    return false;
+}
+
+Kernel best_kernel() {
+    if (kernel_supported(Kernel::AVX2)) return Kernel::AVX2;
+    if (kernel_supported(Kernel::SSE41)) return Kernel::SSE41;
+    return Kernel::SCALAR;
+}
+
+Kernel kernel() { return g_kernel; }
+
+void set_kernel(Kernel k) {
+    g_kernel = kernel_supported(k) ? k : Kernel::SCALAR;
+}
+
+bool select_kernel(std::string_view name) {
+    if (name == "auto") {
+        g_kernel = best_kernel();
+        return true;
+    }
+    for (Kernel k : {Kernel::SCALAR, Kernel::SSE41, Kernel::AVX2}) {
+        if (name != kernel_name(k)) continue;
+        if (!kernel_supported(k)) return false;
+        g_kernel = k;
+        return true;
+    }
+    return false;
+}
+
+// ── Step ────────────────────────────────────────────
+
+void step_with(Kernel k, SimStore& s, size_t begin, size_t end, float dt) {
+    end = std::min(end, s.size());
+    if (begin >= end) return;
+
+    switch (k) {
+#ifdef PHYSICS_X86
+        case Kernel::AVX2:  step_avx2(s, begin, end, dt);  return;
+        case Kernel::SSE41: step_sse41(s, begin, end, dt); return;
+#endif
+        default:            step_scalar(s, begin, end, dt); return;
+    }
+}
+
+void step(SimStore& s, size_t begin, size_t end, float dt) {
+    step_with(g_kernel, s, begin, end, dt);
+}
+
+} // namespace game::physics
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace game {
+
+// ── Player id interning ─────────────────────────────
+// Player ids are JWT `sub` strings (UUIDs). Each is interned once, when its
+// connection is upgraded, into a 32-bit PlayerHandle; rooms and socket
+// registries work on handles, and the string is only read again at the
+// protocol boundary (JSON messages, logs, checkpoints).
+//
+// Handles are reference counted: a connection holds one, and so does the
+// seat of a player in a room (also while they are disconnected). Released
+// handles are reused, so they stay small and dense enough to index arrays.
+// Thread-safe; one table per process, so a handle means the same player on
+// every loop and rooms can move between them.
+using PlayerHandle = uint32_t;
+constexpr PlayerHandle NO_PLAYER = 0;
+
+class PlayerIds {
+public:
+    PlayerIds() : ids_(1), refs_(1) {}  // handle 0 is NO_PLAYER
+
+    PlayerIds(const PlayerIds&) = delete;
+    PlayerIds& operator=(const PlayerIds&) = delete;
+
+    // Handle for `id`, interning it if needed; takes a reference
+    PlayerHandle acquire(std::string_view id) {
+        std::lock_guard lock(mutex_);
+        if (auto it = by_id_.find(id); it != by_id_.end()) {
+            refs_[it->second]++;
+            return it->second;
+        }
+
+        PlayerHandle h;
+        if (!free_.empty()) {
+            h = free_.back();
+            free_.pop_back();
+        } else {
+            h = static_cast<PlayerHandle>(ids_.size());
+            ids_.emplace_back();
+            refs_.push_back(0);
+        }
+        ids_[h] = id;
+        refs_[h] = 1;
+        by_id_.emplace(ids_[h], h);
+        return h;
+    }
+
+    // Handle of an interned id without taking a reference; NO_PLAYER if none
+    PlayerHandle find(std::string_view id) const {
+        std::lock_guard lock(mutex_);
+        auto it = by_id_.find(id);
+        return it != by_id_.end() ? it->second : NO_PLAYER;
+    }
+
+    // Another reference on a handle already held
+    PlayerHandle retain(PlayerHandle h) {
+        if (h == NO_PLAYER) return h;
+        std::lock_guard lock(mutex_);
+        refs_[h]++;
+        return h;
+    }
+
+    // Drops a reference; the last one frees the handle for reuse
+    void release(PlayerHandle h) {
+        if (h == NO_PLAYER) return;
+        std::lock_guard lock(mutex_);
+        if (--refs_[h] > 0) return;
+        by_id_.erase(ids_[h]);
+        ids_[h].clear();
+        free_.push_back(h);
+    }
+
+    // Ids currently interned, for /info
+    size_t size() const {
+        std::lock_guard lock(mutex_);
+        return by_id_.size();
+    }
+
+private:
+    // Lets by_id_ be searched with a string_view
+    struct Hash {
+        using is_transparent = void;
+        size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+    };
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, PlayerHandle, Hash, std::equal_to<>> by_id_;
+    std::vector<std::string> ids_;    // handle → id
+    std::vector<uint32_t> refs_;      // handle → references
+    std::vector<PlayerHandle> free_;
+};
+
+// The process-wide table
+inline PlayerIds& player_ids() {
+    static PlayerIds ids;
+    return ids;
+}
+
+} // namespace game
@@ -1,43 +1,69 @@
 #include "game/room.h"
+#include "network/json_writer.h"
 #include "utils/logger.h"
 
+#include <algorithm>
+#include <cstring>
+
 namespace game {
 
-Room::Room(std::string id, int max_players)
-    : id_(std::move(id)), max_players_(max_players) {}
+Room::Room(std::string id, int max_players, SimWorld* world)
+    : id_(std::move(id)),
+      max_players_(max_players),
+      seats_(max_players),
+      own_world_(world ? nullptr : std::make_unique<SimWorld>()),
+      world_(world ? world : own_world_.get()),
+      base_(world_->acquire(max_players)) {}
+
+Room::~Room() {
+    for (const auto& seat : seats_) player_ids().release(seat.handle);
+    world_->release(base_, max_players_);
+}
 
 // ── Player management ───────────────────────────────
 
 bool Room::add_player(const Player& player) {
-    if (has_player(player.id)) return false;
-
-    Player p = player;
+    PlayerHandle handle = player.handle != NO_PLAYER ? player.handle : player_ids().find(player.id);
+    if (has_player(handle)) return false;
 
     // Check if this is a reconnecting player during gameplay
-    auto disc_it = disconnected_players_.find(player.id);
-    if (disc_it != disconnected_players_.end()) {
-        // Restore their state from before disconnect
-        p = disc_it->second;
+    int slot = slot_of(handle);
+    if (slot >= 0) {
+        // Their seat and simulation lane were kept — just reattach
+        auto& p = seats_[slot];
         p.name = player.name;  // Update name in case it changed
         p.display_name = player.display_name;
-        disconnected_players_.erase(disc_it);
+        p.wire_format = player.wire_format;  // new connection may negotiate differently
+        p.acked_tick = -1;                   // and has no delta baseline yet
+        disconnected_count_--;
         logger::info("player " + p.id + " (" + p.name + ") reconnected to room " + id_
-                     + " at (" + std::to_string((int)p.x) + "," + std::to_string((int)p.y) + ")");
+                     + " at (" + std::to_string((int)sim().x[lane(slot)]) + "," + std::to_string((int)sim().y[lane(slot)]) + ")");
     } else {
         // New player
         if (is_full()) return false;
         if (state_ == RoomState::FINISHED) return false;
 
+        slot = allocate_slot();
+        if (slot < 0) return false;
+        seats_[slot] = player;
+        seats_[slot].handle = handle != NO_PLAYER ? player_ids().retain(handle)
+                                                  : player_ids().acquire(player.id);
+        seats_[slot].slot = slot;
+        sim().reset(lane(slot));
+        sim().flags[lane(slot)] |= SIM_OCCUPIED;
+
         if (state_ == RoomState::PLAYING) {
             int idx = next_spawn_ % 4;
-            p.spawn(spawn_positions_[idx][0], spawn_positions_[idx][1]);
+            sim().spawn(lane(slot), spawn_positions_[idx][0], spawn_positions_[idx][1]);
             next_spawn_++;
         }
 
-        logger::info("player " + p.id + " (" + p.name + ") joined room " + id_);
+        logger::info("player " + player.id + " (" + player.name + ") joined room " + id_
+                     + " slot=" + std::to_string(slot));
     }
 
-    players_.emplace(p.id, p);
+    sim().flags[lane(slot)] |= SIM_CONNECTED;
+    connected_count_++;
 
     // Room is no longer empty
     empty_since_.reset();
@@ -45,23 +71,26 @@ bool Room::add_player(const Player& player) {
     return true;
 }
 
-void Room::remove_player(const std::string& player_id) {
-    auto it = players_.find(player_id);
-    if (it == players_.end()) return;
+void Room::remove_player(PlayerHandle player) {
+    auto* p = connected_seat(player);
+    if (!p) return;
+    int slot = p->slot;
 
-    // If game is in progress, save player state for reconnection
+    sim().flags[lane(slot)] &= ~SIM_CONNECTED;
+    connected_count_--;
+
+    // If game is in progress, keep the seat for reconnection
     if (state_ == RoomState::PLAYING) {
-        disconnected_players_[player_id] = it->second;
-        logger::info("player " + player_id + " disconnected from room " + id_
+        disconnected_count_++;
+        logger::info("player " + p->id + " disconnected from room " + id_
                      + " (saved for reconnect, grace=" + std::to_string(GRACE_SECONDS) + "s)");
     } else {
-        logger::info("player " + player_id + " left room " + id_);
+        logger::info("player " + p->id + " left room " + id_);
+        free_seat(slot);
     }
 
-    players_.erase(it);
-
-    if (players_.empty()) {
-        if (state_ == RoomState::PLAYING && !disconnected_players_.empty()) {
+    if (connected_count_ == 0) {
+        if (state_ == RoomState::PLAYING && disconnected_count_ > 0) {
             // Start grace period — keep room alive for reconnection
             empty_since_ = Clock::now();
             logger::info("room " + id_ + " has no connected players, grace period started");
@@ -72,30 +101,70 @@ void Room::remove_player(const std::string& player_id) {
     }
 }
 
-bool Room::has_player(const std::string& player_id) const {
-    return players_.count(player_id) > 0;
+int Room::slot_of(PlayerHandle player) const {
+    if (player == NO_PLAYER) return -1;
+    for (size_t slot = 0; slot < seats_.size(); ++slot) {
+        if (seats_[slot].handle == player) return static_cast<int>(slot);
+    }
+    return -1;
+}
+
+Player* Room::connected_seat(PlayerHandle player) {
+    int slot = slot_of(player);
+    if (slot < 0 || !sim().connected(lane(slot))) return nullptr;
+    return &seats_[slot];
+}
+
+const Player* Room::connected_seat(PlayerHandle player) const {
+    int slot = slot_of(player);
+    if (slot < 0 || !sim().connected(lane(slot))) return nullptr;
+    return &seats_[slot];
+}
+
+void Room::free_seat(int slot) {
+    player_ids().release(seats_[slot].handle);
+    seats_[slot] = Player{};
+    sim().flags[lane(slot)] &= SIM_ACTIVE;
+}
+
+bool Room::has_player(PlayerHandle player) const {
+    return connected_seat(player) != nullptr;
 }
 
-std::optional<Player> Room::get_player(const std::string& player_id) const {
-    auto it = players_.find(player_id);
-    if (it == players_.end()) return std::nullopt;
-    return it->second;
+std::optional<Player> Room::get_player(PlayerHandle player) const {
+    auto* p = connected_seat(player);
+    if (!p) return std::nullopt;
+    return *p;
 }
 
 bool Room::is_full() const {
-    return static_cast<int>(players_.size()) >= max_players_;
+    return connected_count_ >= max_players_;
 }
 
 bool Room::is_empty() const {
-    return players_.empty();
+    return connected_count_ == 0;
 }
 
 int Room::player_count() const {
-    return static_cast<int>(players_.size());
+    return connected_count_;
+}
+
+int Room::allocate_slot() {
+    for (size_t slot = 0; slot < seats_.size(); ++slot) {
+        if (!(sim().flags[base_ + slot] & SIM_OCCUPIED)) return static_cast<int>(slot);
+    }
+    return -1;
+}
+
+void Room::set_lanes_active(bool active) {
+    for (size_t i = base_; i < base_ + seats_.size(); ++i) {
+        if (active) sim().flags[i] |= SIM_ACTIVE;
+        else        sim().flags[i] &= ~SIM_ACTIVE;
+    }
 }
 
 bool Room::should_cleanup() const {
-    if (state_ == RoomState::FINISHED && players_.empty()) return true;
+    if (state_ == RoomState::FINISHED && connected_count_ == 0) return true;
 
     // Check grace period expiry
     if (empty_since_) {
@@ -109,21 +178,194 @@ bool Room::should_cleanup() const {
     return false;
 }
 
+// ── Migration ───────────────────────────────────────
+
+std::vector<PlayerHandle> Room::players() const {
+    std::vector<PlayerHandle> handles;
+    handles.reserve(connected_count_);
+    for_each_connected([&](const Player& p) { handles.push_back(p.handle); });
+    return handles;
+}
+
+void Room::detach_all() {
+    if (connected_count_ == 0) return;
+
+    for (size_t slot = 0; slot < seats_.size(); ++slot) {
+        sim().flags[base_ + slot] &= ~SIM_CONNECTED;
+    }
+    disconnected_count_ += connected_count_;
+    connected_count_ = 0;
+    empty_since_ = Clock::now();
+}
+
+void Room::move_to_world(SimWorld* world) {
+    auto own = world ? nullptr : std::make_unique<SimWorld>();
+    SimWorld* dst = world ? world : own.get();
+    size_t base = dst->acquire(seats_.size());
+    dst->lanes.copy_lanes(base, sim(), base_, seats_.size());
+
+    world_->release(base_, seats_.size());
+    own_world_ = std::move(own);  // frees the old private world, if any
+    world_ = dst;
+    base_ = base;
+}
+
+// ── Checkpoints ─────────────────────────────────────
+
+namespace {
+
+void put_f32(std::string& out, float v) {
+    uint32_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    network::binary::put_u32(out, bits);
+}
+
+void put_str(std::string& out, const std::string& s) {
+    size_t n = std::min<size_t>(s.size(), 255);
+    network::binary::put_u8(out, static_cast<uint8_t>(n));
+    out.append(s, 0, n);
+}
+
+// Bounds-checked reader over a checkpoint; any short read sets `ok` false
+struct CheckpointReader {
+    std::string_view in;
+    bool ok = true;
+
+    uint8_t u8() {
+        if (in.empty()) { ok = false; return 0; }
+        auto v = static_cast<uint8_t>(in[0]);
+        in.remove_prefix(1);
+        return v;
+    }
+    uint32_t u32() {
+        uint32_t v = 0;
+        for (int i = 0; i < 4; ++i) v |= static_cast<uint32_t>(u8()) << (8 * i);
+        return v;
+    }
+    float f32() {
+        uint32_t bits = u32();
+        float v;
+        std::memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+    std::string str() {
+        size_t n = u8();
+        if (in.size() < n) { ok = false; return {}; }
+        std::string s(in.substr(0, n));
+        in.remove_prefix(n);
+        return s;
+    }
+};
+
+} // namespace
+
+bool Room::write_checkpoint(std::string& out) const {
+    namespace bin = network::binary;
+    if (state_ != RoomState::PLAYING) return false;
+
+    bin::put_u8(out, CHECKPOINT_VERSION);
+    bin::put_u8(out, static_cast<uint8_t>(max_players_));
+    bin::put_u32(out, static_cast<uint32_t>(tick_));
+    bin::put_u8(out, static_cast<uint8_t>(next_spawn_));
+
+    size_t count_pos = out.size();
+    bin::put_u8(out, 0);
+    uint8_t count = 0;
+    for (size_t slot = 0; slot < seats_.size(); ++slot) {
+        size_t i = base_ + slot;
+        if (!(sim().flags[i] & SIM_OCCUPIED)) continue;
+        const Player& p = seats_[slot];
+        bin::put_u8(out, static_cast<uint8_t>(slot));
+        put_str(out, p.id);
+        put_str(out, p.name);
+        put_str(out, p.display_name);
+        bin::put_u8(out, p.ready ? 1 : 0);
+        bin::put_u32(out, static_cast<uint32_t>(p.gold));
+        put_f32(out, sim().x[i]);
+        put_f32(out, sim().y[i]);
+        put_f32(out, sim().vx[i]);
+        put_f32(out, sim().vy[i]);
+        bin::put_u32(out, static_cast<uint32_t>(sim().health[i]));
+        bin::put_u32(out, static_cast<uint32_t>(sim().max_health[i]));
+        bin::put_u8(out, static_cast<uint8_t>(static_cast<uint8_t>(sim().state[i])
+                                              | (static_cast<uint8_t>(sim().facing[i]) << 4)));
+        ++count;
+    }
+    out[count_pos] = static_cast<char>(count);
+    return true;
+}
+
+std::unique_ptr<Room> Room::restore(std::string id, std::string_view checkpoint, SimWorld* world) {
+    CheckpointReader r{checkpoint};
+    if (r.u8() != CHECKPOINT_VERSION) return nullptr;
+    int max_players = r.u8();
+    int tick = static_cast<int>(r.u32());
+    int next_spawn = r.u8();
+    int count = r.u8();
+    if (!r.ok || max_players == 0 || count == 0 || count > max_players) return nullptr;
+
+    auto room = std::make_unique<Room>(std::move(id), max_players, world);
+    room->state_ = RoomState::PLAYING;
+    room->tick_ = tick;
+    room->next_spawn_ = next_spawn;
+
+    auto& s = room->sim();
+    for (int n = 0; n < count; ++n) {
+        size_t slot = r.u8();
+        Player p;
+        p.id = r.str();
+        p.name = r.str();
+        p.display_name = r.str();
+        p.ready = r.u8() != 0;
+        p.gold = static_cast<int>(r.u32());
+        float x = r.f32(), y = r.f32(), vx = r.f32(), vy = r.f32();
+        auto health = static_cast<int32_t>(r.u32());
+        auto max_health = static_cast<int32_t>(r.u32());
+        uint8_t state_facing = r.u8();
+        if (!r.ok || slot >= room->seats_.size() || p.id.empty()
+            || room->slot_of(player_ids().find(p.id)) >= 0 || (s.flags[room->lane(slot)] & SIM_OCCUPIED)) {
+            return nullptr;
+        }
+
+        size_t i = room->lane(slot);
+        s.reset(i);
+        s.x[i] = x;
+        s.y[i] = y;
+        s.vx[i] = vx;
+        s.vy[i] = vy;
+        s.health[i] = health;
+        s.max_health[i] = max_health;
+        s.state[i] = static_cast<PlayerState>(std::min<uint8_t>(state_facing & 0x0F, static_cast<uint8_t>(PlayerState::DEAD)));
+        s.facing[i] = (state_facing >> 4) ? Facing::LEFT : Facing::RIGHT;
+        s.flags[i] = SIM_OCCUPIED;
+
+        p.slot = static_cast<int>(slot);
+        p.handle = player_ids().acquire(p.id);
+        room->seats_[slot] = std::move(p);
+    }
+
+    // Everyone is held, as after detach_all()
+    room->set_lanes_active(true);
+    room->disconnected_count_ = count;
+    room->empty_since_ = Clock::now();
+    return room;
+}
+
 // ── Lobby ───────────────────────────────────────────
 
-void Room::set_player_ready(const std::string& player_id, bool ready) {
-    auto it = players_.find(player_id);
-    if (it == players_.end()) return;
+void Room::set_player_ready(PlayerHandle player, bool ready) {
+    auto* p = connected_seat(player);
+    if (!p) return;
 
-    it->second.ready = ready;
+    p->ready = ready;
 
     broadcast({
         {"type", "player_ready_state"},
-        {"player_id", player_id},
+        {"player_id", p->id},
         {"ready", ready}
     });
 
-    logger::debug("player " + player_id + " ready=" + (ready ? "true" : "false")
+    logger::debug("player " + p->id + " ready=" + (ready ? "true" : "false")
                   + " in room " + id_);
 
     // Auto-start when all players are ready (min 2)
@@ -134,23 +376,21 @@ void Room::set_player_ready(const std::string& player_id, bool ready) {
 }
 
 bool Room::all_ready() const {
-    if (players_.empty()) return false;
-    if (players_.size() < 2) return false;
-    for (const auto& [_, p] : players_) {
-        if (!p.ready) return false;
-    }
-    return true;
+    if (connected_count_ < 2) return false;
+    bool ready = true;
+    for_each_connected([&](const Player& p) { ready = ready && p.ready; });
+    return ready;
 }
 
 // ── Chat ────────────────────────────────────────────
 
-void Room::handle_chat(const std::string& sender_id, const std::string& message) {
-    auto player = get_player(sender_id);
+void Room::handle_chat(PlayerHandle sender, const std::string& message) {
+    auto* player = connected_seat(sender);
     if (!player) return;
 
     broadcast({
         {"type", "chat_message"},
-        {"player_id", sender_id},
+        {"player_id", player->id},
         {"player_name", player->name},
         {"message", message}
     });
@@ -164,23 +404,23 @@ void Room::start_game() {
     state_ = RoomState::PLAYING;
     tick_ = 0;
     next_spawn_ = 0;
+    set_lanes_active(true);
 
     // Spawn all players at different positions
-    for (auto& [pid, player] : players_) {
+    nlohmann::json spawn_points = nlohmann::json::array();
+    for_each_connected([&](const Player& player) {
         int idx = next_spawn_ % 4;
-        player.spawn(spawn_positions_[idx][0], spawn_positions_[idx][1]);
+        sim().spawn(lane(player.slot), spawn_positions_[idx][0], spawn_positions_[idx][1]);
         next_spawn_++;
-    }
 
-    // Build spawn points array for the client
-    nlohmann::json spawn_points = nlohmann::json::array();
-    for (const auto& [pid, player] : players_) {
+        // Spawn points array for the client
         spawn_points.push_back({
-            {"player_id", pid},
-            {"x", player.x},
-            {"y", player.y}
+            {"player_id", player.id},
+            {"slot", player.slot},
+            {"x", sim().x[lane(player.slot)]},
+            {"y", sim().y[lane(player.slot)]}
         });
-    }
+    });
 
     // Notify all clients
     broadcast({
@@ -198,7 +438,13 @@ void Room::start_game() {
 }
 
 void Room::update(float dt) {
-    if (state_ != RoomState::PLAYING) return;
+    if (!begin_update()) return;
+    physics::step(sim(), base_, base_ + seats_.size(), dt);
+    finish_update();
+}
+
+bool Room::begin_update() {
+    if (state_ != RoomState::PLAYING) return false;
 
     // Check grace period expiry
     if (empty_since_) {
@@ -207,33 +453,47 @@ void Room::update(float dt) {
         if (elapsed >= GRACE_SECONDS) {
             logger::info("room " + id_ + " grace period expired, marking finished");
             state_ = RoomState::FINISHED;
-            disconnected_players_.clear();
-            return;
+            set_lanes_active(false);
+            for (size_t slot = 0; slot < seats_.size(); ++slot) {
+                if ((sim().flags[base_ + slot] & SIM_OCCUPIED) && !sim().connected(base_ + slot)) {
+                    free_seat(static_cast<int>(slot));
+                }
+            }
+            disconnected_count_ = 0;
+            return false;
         }
     }
 
     // Don't tick if no players are connected
-    if (players_.empty()) return;
+    if (connected_count_ == 0) return false;
 
     tick_++;
+    return true;
+}
 
-    // Process pending inputs for each player
-    for (auto& [pid, player] : players_) {
-        player.process_input(dt);
-    }
+void Room::finish_update() {
+    // Physics has consumed the pending inputs — broadcast game state every
+    // tick to connected players
+    broadcast_game_state();
+}
 
-    // Broadcast game state every tick to connected players
-    broadcast(game_state());
+void Room::queue_input(PlayerHandle player, int tick, PlayerInput input) {
+    auto* p = connected_seat(player);
+    if (!p) return;
+
+    sim().set_input(lane(p->slot), input);
+    p->last_input_tick = tick;
 }
 
-void Room::queue_input(const std::string& player_id,
-                       int tick,
-                       const std::vector<std::string>& actions) {
-    auto it = players_.find(player_id);
-    if (it == players_.end()) return;
+void Room::ack_snapshot(PlayerHandle player, int tick) {
+    auto* p = connected_seat(player);
+    if (!p) return;
 
-    it->second.pending_actions = actions;
-    it->second.last_input_tick = tick;
+    // Acks may arrive out of order; never move the baseline backwards
+    // or past what we actually sent
+    if (tick > p->acked_tick && tick <= tick_) {
+        p->acked_tick = tick;
+    }
 }
 
 // ── Broadcasting ────────────────────────────────────
@@ -242,36 +502,150 @@ void Room::set_broadcast_fn(BroadcastFn fn) {
     broadcast_fn_ = std::move(fn);
 }
 
+void Room::set_publish_fn(PublishFn fn) {
+    publish_fn_ = std::move(fn);
+}
+
 void Room::broadcast(const nlohmann::json& msg) {
+    if (publish_fn_) {
+        publish_fn_(Topic::ALL, msg.dump(), false);
+        return;
+    }
+
     if (!broadcast_fn_) return;
     std::string serialized = msg.dump();
-    for (const auto& [pid, _] : players_) {
-        broadcast_fn_(pid, serialized);
-    }
+    for_each_connected([&](const Player& p) {
+        broadcast_fn_(p.handle, serialized, false);
+    });
 }
 
-void Room::broadcast_except(const std::string& exclude_id, const nlohmann::json& msg) {
+void Room::broadcast_except(PlayerHandle exclude, const nlohmann::json& msg) {
     if (!broadcast_fn_) return;
     std::string serialized = msg.dump();
-    for (const auto& [pid, _] : players_) {
-        if (pid != exclude_id) {
-            broadcast_fn_(pid, serialized);
+    for_each_connected([&](const Player& p) {
+        if (p.handle != exclude) {
+            broadcast_fn_(p.handle, serialized, false);
         }
-    }
+    });
 }
 
-void Room::send_to(const std::string& player_id, const nlohmann::json& msg) {
+void Room::send_to(PlayerHandle player, const nlohmann::json& msg) {
     if (!broadcast_fn_) return;
-    broadcast_fn_(player_id, msg.dump());
+    broadcast_fn_(player, msg.dump(), false);
+}
+
+const Room::SnapshotRecord* Room::find_snapshot(int tick) const {
+    if (tick < 0) return nullptr;
+    const auto& rec = history_[tick % SNAPSHOT_HISTORY];
+    return rec.tick == tick ? &rec : nullptr;
+}
+
+void Room::broadcast_game_state() {
+    encode_game_state();
+    send_game_state();
+}
+
+void Room::encode_game_state() {
+    pending_sends_.clear();
+    publish_json_ = false;
+    publish_binary_ = false;
+    if (!broadcast_fn_ && !publish_fn_) return;
+
+    // Quantize once; the record doubles as the baseline for future deltas
+    auto& current = history_[tick_ % SNAPSHOT_HISTORY];
+    current.tick = tick_;
+    current.players.clear();
+    for (size_t slot = 0; slot < seats_.size(); ++slot) {
+        if (sim().connected(base_ + slot)) {
+            current.players.push_back(network::quantize_lane(sim(), base_ + slot, slot));
+        }
+    }
+
+    // time_left/round: same Phase 3 placeholders as game_state()
+    constexpr float time_left = 60.0f;
+    constexpr int round = 1;
+    bool keyframe = tick_ % KEYFRAME_INTERVAL == 0;
+
+    // Encode each frame at most once per tick, and only if someone uses it.
+    // Delta frames are cached per baseline — clients usually ack the same tick.
+    json_frame_.clear();
+    binary_frame_.clear();
+    delta_frames_used_ = 0;
+
+    auto encode_json = [&] {
+        if (!json_frame_.empty()) return;
+        network::write_game_state_json(json_frame_, tick_, time_left, round, seats_, sim(), base_);
+    };
+    auto encode_binary = [&] {
+        if (!binary_frame_.empty()) return;
+        network::encode_game_state(binary_frame_, tick_, time_left, round, current.players);
+    };
+    auto encode_delta = [&](const SnapshotRecord& baseline) -> int {
+        for (size_t i = 0; i < delta_frames_used_; ++i) {
+            if (delta_frames_[i].first == baseline.tick) return static_cast<int>(i);
+        }
+        if (delta_frames_used_ == delta_frames_.size()) delta_frames_.emplace_back();
+        auto& [frame_baseline, frame] = delta_frames_[delta_frames_used_];
+        frame_baseline = baseline.tick;
+        frame.clear();
+        network::encode_game_state_delta(frame, tick_, baseline.tick, time_left, round,
+                                         baseline.players, current.players);
+        return static_cast<int>(delta_frames_used_++);
+    };
+
+    for_each_connected([&](const Player& p) {
+        // JSON and plain binary clients share one topic publish per format
+        if (publish_fn_ && p.wire_format != network::WireFormat::BINARY_DELTA) {
+            if (p.wire_format == network::WireFormat::BINARY) publish_binary_ = true;
+            else publish_json_ = true;
+            return;
+        }
+        if (!broadcast_fn_) return;
+
+        const SnapshotRecord* baseline = nullptr;
+        if (p.wire_format == network::WireFormat::BINARY_DELTA && !keyframe
+            && tick_ - p.acked_tick < SNAPSHOT_HISTORY) {
+            baseline = find_snapshot(p.acked_tick);
+        }
+
+        if (baseline) {
+            pending_sends_.push_back({static_cast<size_t>(p.slot), encode_delta(*baseline)});
+        } else if (p.wire_format != network::WireFormat::JSON) {
+            // Binary clients, plus delta clients without a usable baseline
+            encode_binary();
+            pending_sends_.push_back({static_cast<size_t>(p.slot), FRAME_BINARY});
+        } else {
+            encode_json();
+            pending_sends_.push_back({static_cast<size_t>(p.slot), FRAME_JSON});
+        }
+    });
+
+    if (publish_json_) encode_json();
+    if (publish_binary_) encode_binary();
+}
+
+void Room::send_game_state() {
+    for (const auto& send : pending_sends_) {
+        PlayerHandle player = seats_[send.slot].handle;
+        if (send.frame == FRAME_JSON) broadcast_fn_(player, json_frame_, false);
+        else if (send.frame == FRAME_BINARY) broadcast_fn_(player, binary_frame_, true);
+        else broadcast_fn_(player, delta_frames_[send.frame].second, true);
+    }
+    pending_sends_.clear();
+
+    if (publish_json_) publish_fn_(Topic::GAME_STATE_JSON, json_frame_, false);
+    if (publish_binary_) publish_fn_(Topic::GAME_STATE_BINARY, binary_frame_, true);
+    publish_json_ = false;
+    publish_binary_ = false;
 }
 
 // ── State snapshots ─────────────────────────────────
 
 nlohmann::json Room::lobby_state() const {
     nlohmann::json players_arr = nlohmann::json::array();
-    for (const auto& [_, p] : players_) {
+    for_each_connected([&](const Player& p) {
         players_arr.push_back(p.to_lobby_json());
-    }
+    });
     return {
         {"type", "lobby_state"},
         {"room_id", id_},
@@ -282,10 +656,21 @@ nlohmann::json Room::lobby_state() const {
 }
 
 nlohmann::json Room::game_state() const {
+    // Tick path uses network::write_game_state_json() — keep the two in sync
     nlohmann::json players_arr = nlohmann::json::array();
-    for (const auto& [_, p] : players_) {
-        players_arr.push_back(p.to_game_json());
-    }
+    for_each_connected([&](const Player& p) {
+        size_t i = lane(p.slot);
+        players_arr.push_back({
+            {"id", p.id},
+            {"x", quantize(sim().x[i]) / 10.0},
+            {"y", quantize(sim().y[i]) / 10.0},
+            {"vx", quantize(sim().vx[i]) / 10.0},
+            {"vy", quantize(sim().vy[i]) / 10.0},
+            {"health", sim().health[i]},
+            {"state", to_string(sim().state[i])},
+            {"facing", to_string(sim().facing[i])}
+        });
+    });
 
     return {
         {"type", "game_state"},
@@ -1,14 +1,19 @@
 #pragma once
 
 #include <string>
-#include <unordered_map>
+#include <string_view>
 #include <vector>
 #include <functional>
 #include <optional>
 #include <chrono>
+#include <array>
+#include <memory>
+#include <cstdint>
 #include <nlohmann/json.hpp>
 
 #include "game/player.h"
+#include "game/sim_store.h"
+#include "network/binary_codec.h"
 
 namespace game {
 
@@ -25,39 +30,83 @@ inline std::string room_state_str(RoomState s) {
 
 class Room {
 public:
-    using BroadcastFn = std::function<void(const std::string& player_id, const std::string& message)>;
+    // binary=true marks a BINARY frame (game_state for wombocombo.bin.v1 clients)
+    using BroadcastFn = std::function<void(PlayerHandle player,
+                                           const std::string& message,
+                                           bool binary)>;
+
+    // Room-wide pub/sub channels. The server subscribes every connection to
+    // ALL plus the game_state topic of its wire format (delta clients get
+    // per-player frames via BroadcastFn instead), so a message published here
+    // is framed once and fanned out by the socket layer.
+    enum class Topic { ALL, GAME_STATE_JSON, GAME_STATE_BINARY };
+    using PublishFn = std::function<void(Topic topic, const std::string& message, bool binary)>;
     using Clock = std::chrono::steady_clock;
 
-    explicit Room(std::string id, int max_players = 4);
+    // `world` holds the room's simulation lanes; shared by every room on a
+    // server so one physics pass steps them all. Without one, the room keeps
+    // a private world (benchmarks, tools).
+    explicit Room(std::string id, int max_players = 4, SimWorld* world = nullptr);
+    ~Room();
+
+    Room(const Room&) = delete;
+    Room& operator=(const Room&) = delete;
 
     // ── Player management ───────────────────────────
+    // Players are addressed by interned handle (see player_ids.h). A new
+    // seat takes its own reference on `player.handle`, or interns
+    // `player.id` if the handle is unset (benchmarks, tools).
     bool add_player(const Player& player);
-    void remove_player(const std::string& player_id);
-    bool has_player(const std::string& player_id) const;
-    std::optional<Player> get_player(const std::string& player_id) const;
+    void remove_player(PlayerHandle player);
+    bool has_player(PlayerHandle player) const;
+    std::optional<Player> get_player(PlayerHandle player) const;
     bool is_full() const;
     bool is_empty() const;
     int player_count() const;
 
     // ── Lobby ───────────────────────────────────────
-    void set_player_ready(const std::string& player_id, bool ready);
+    void set_player_ready(PlayerHandle player, bool ready);
     bool all_ready() const;
 
     // ── Chat ────────────────────────────────────────
-    void handle_chat(const std::string& sender_id, const std::string& message);
+    void handle_chat(PlayerHandle sender, const std::string& message);
 
     // ── Gameplay (Phase 2) ──────────────────────────
     void start_game();
+
+    // One tick on its own: begin_update(), step this room's lanes, finish_update()
     void update(float dt);
-    void queue_input(const std::string& player_id,
-                     int tick,
-                     const std::vector<std::string>& actions);
+
+    // Batched tick, driven by the server for every PLAYING room:
+    //   begin_update() on each room, one physics::step() over the shared
+    //   world, then finish_update() on each room that returned true
+    //   (or its two halves, encode_game_state() and send_game_state()).
+    // begin_update() handles the grace period and advances the tick; it
+    // returns false if nothing should be simulated or broadcast.
+    bool begin_update();
+    void finish_update();
+    void queue_input(PlayerHandle player, int tick, PlayerInput input);
+
+    // Client confirmed it applied the game_state for `tick` (delta baseline)
+    void ack_snapshot(PlayerHandle player, int tick);
 
     // ── Broadcasting ────────────────────────────────
     void set_broadcast_fn(BroadcastFn fn);
+    void set_publish_fn(PublishFn fn);
     void broadcast(const nlohmann::json& msg);
-    void broadcast_except(const std::string& exclude_id, const nlohmann::json& msg);
-    void send_to(const std::string& player_id, const nlohmann::json& msg);
+    void broadcast_except(PlayerHandle exclude, const nlohmann::json& msg);
+    void send_to(PlayerHandle player, const nlohmann::json& msg);
+
+    // Sends the current snapshot to every player in their negotiated format:
+    // encode_game_state() then send_game_state()
+    void broadcast_game_state();
+
+    // The two halves of broadcast_game_state(). encode_game_state() only
+    // touches this room's own buffers and lanes, so rooms can encode in
+    // parallel; send_game_state() calls the broadcast/publish callbacks and
+    // must run on the loop thread. Nothing else may touch the room in between.
+    void encode_game_state();
+    void send_game_state();
 
     // ── Accessors ───────────────────────────────────
     const std::string& id() const { return id_; }
@@ -68,6 +117,48 @@ public:
     // ── Grace period for reconnection ───────────────
     bool should_cleanup() const;
 
+    // ── Migration between loops ─────────────────────
+    // Handles of connected players
+    std::vector<PlayerHandle> players() const;
+
+    // Turns every connected player into a held seat, as if they had all
+    // dropped at once: state, tick, slots and lanes are kept, and each
+    // player reattaches with add_player() within the grace period.
+    void detach_all();
+
+    // Moves the room's lanes into `world` (nullptr = a private one). The old
+    // and new world may belong to different threads, so a move between
+    // loops goes through a private world on each side.
+    void move_to_world(SimWorld* world);
+
+    // ── Checkpoints (failover to another node) ──────
+    // Compact binary image of a PLAYING room: tick, round state and every
+    // occupied seat with its lane, floats bit-exact. Little-endian:
+    //
+    //   u8   CHECKPOINT_VERSION
+    //   u8   max_players
+    //   u32  tick
+    //   u8   next_spawn
+    //   u8   seat_count
+    //   per seat:
+    //     u8   slot
+    //     str  id, name, display_name   (u8 length + bytes)
+    //     u8   ready
+    //     u32  gold
+    //     f32  x, y, vx, vy
+    //     u32  health, max_health
+    //     u8   state | facing << 4
+    //
+    // Appends to `out`; returns false (writing nothing) unless PLAYING.
+    static constexpr uint8_t CHECKPOINT_VERSION = 1;
+    bool write_checkpoint(std::string& out) const;
+
+    // Rebuilds a room from write_checkpoint() output with every player held
+    // as disconnected, so they reattach with add_player() within a grace
+    // period that starts now. nullptr if the checkpoint is malformed.
+    static std::unique_ptr<Room> restore(std::string id, std::string_view checkpoint,
+                                         SimWorld* world = nullptr);
+
     // ── State snapshots ─────────────────────────────
     nlohmann::json lobby_state() const;
     nlohmann::json game_state() const;
@@ -78,11 +169,20 @@ private:
     RoomState state_ = RoomState::WAITING;
     int tick_ = 0;
 
-    std::unordered_map<std::string, Player> players_;
-    BroadcastFn broadcast_fn_;
+    // ── Seats ───────────────────────────────────────
+    // Players are seated in stable slots. Identity/lobby data lives in
+    // seats_[slot], simulation state in lane base_ + slot of the world. A
+    // player who disconnects during PLAYING keeps their seat (SIM_OCCUPIED
+    // without SIM_CONNECTED) so they can reconnect where they left off.
+    std::vector<Player> seats_;
+    std::unique_ptr<SimWorld> own_world_;
+    SimWorld* world_;
+    size_t base_;
+    int connected_count_ = 0;
+    int disconnected_count_ = 0;
 
-    // Track disconnected players for reconnection during PLAYING
-    std::unordered_map<std::string, Player> disconnected_players_;
+    BroadcastFn broadcast_fn_;
+    PublishFn publish_fn_;
 
     // Grace period: keep room alive for 30s after last player leaves
     static constexpr int GRACE_SECONDS = 30;
@@ -96,6 +196,67 @@ private:
         {800.0f, physics::GROUND_Y}
     };
     int next_spawn_ = 0;
+
+    SimStore& sim() { return world_->lanes; }
+    const SimStore& sim() const { return world_->lanes; }
+    size_t lane(int slot) const { return base_ + static_cast<size_t>(slot); }
+
+    // Lowest slot not held by a connected or disconnected player, -1 if none
+    int allocate_slot();
+
+    // Sets or clears SIM_ACTIVE on every lane of the block
+    void set_lanes_active(bool active);
+
+    // Slot of an occupied seat, -1 if none. A linear scan over at most
+    // max_players handles — cheaper than hashing the id for every message.
+    int slot_of(PlayerHandle player) const;
+
+    // Seat of a connected player, nullptr if not connected here
+    Player* connected_seat(PlayerHandle player);
+    const Player* connected_seat(PlayerHandle player) const;
+
+    void free_seat(int slot);
+
+    template <typename Fn>
+    void for_each_connected(Fn&& fn) const {
+        for (size_t slot = 0; slot < seats_.size(); ++slot) {
+            if (sim().connected(base_ + slot)) fn(seats_[slot]);
+        }
+    }
+
+    // ── Delta snapshot history ──────────────────────
+    // Quantized snapshots of recent ticks, indexed by tick % SNAPSHOT_HISTORY.
+    // A client whose ack is older than the ring gets a full snapshot instead.
+    static constexpr int SNAPSHOT_HISTORY = 32;
+    // Force a full snapshot to delta clients this often (in ticks) so a lost
+    // frame or a buggy client decoder can't drift forever
+    static constexpr int KEYFRAME_INTERVAL = 40;
+
+    struct SnapshotRecord {
+        int tick = -1;
+        std::vector<network::PlayerSnapshot> players;  // in slot order
+    };
+    std::array<SnapshotRecord, SNAPSHOT_HISTORY> history_;
+
+    // Per-tick frame buffers, cleared (not freed) every tick so the
+    // steady-state tick path does no heap allocation
+    std::string json_frame_;
+    std::string binary_frame_;
+    std::vector<std::pair<int, std::string>> delta_frames_;  // baseline tick → frame
+    size_t delta_frames_used_ = 0;
+
+    // What send_game_state() sends this tick, filled by encode_game_state()
+    static constexpr int FRAME_JSON = -1;
+    static constexpr int FRAME_BINARY = -2;
+    struct PendingSend {
+        size_t slot;
+        int frame;  // FRAME_JSON, FRAME_BINARY or an index into delta_frames_
+    };
+    std::vector<PendingSend> pending_sends_;
+    bool publish_json_ = false;
+    bool publish_binary_ = false;
+
+    const SnapshotRecord* find_snapshot(int tick) const;
 };
 
 } // namespace game
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <string_view>
+#include <array>
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <utility>
+
+#include "game/physics.h"
+#include "game/input.h"
+
+namespace game {
+
+// Visual state and facing. The numeric values are the binary wire codes;
+// names are only looked up when serializing to JSON.
+enum class PlayerState : uint8_t { IDLE, RUNNING, JUMPING, FALLING, DEAD };
+enum class Facing : uint8_t { RIGHT, LEFT };
+
+constexpr std::array<std::string_view, 5> PLAYER_STATE_NAMES = {
+    "idle", "running", "jumping", "falling", "dead"
+};
+constexpr std::array<std::string_view, 2> FACING_NAMES = { "right", "left" };
+
+constexpr std::string_view to_string(PlayerState s) { return PLAYER_STATE_NAMES[static_cast<size_t>(s)]; }
+constexpr std::string_view to_string(Facing f)      { return FACING_NAMES[static_cast<size_t>(f)]; }
+
+// Lane flags
+constexpr uint8_t SIM_OCCUPIED  = 1 << 0;  // slot belongs to a player (connected or not)
+constexpr uint8_t SIM_CONNECTED = 1 << 1;  // player is connected — simulated & broadcast
+constexpr uint8_t SIM_ACTIVE    = 1 << 2;  // owning room is PLAYING — lane is stepped if connected
+
+// ── Simulation state, structure-of-arrays ───────────
+// One lane per player seat. Each room owns a fixed block of lanes in a
+// SimWorld (lane = block base + slot). Slots are stable for the life of a
+// seat (including while a player is disconnected during PLAYING), so the
+// tick loop walks contiguous arrays instead of hash nodes.
+struct SimStore {
+    std::vector<float> x, y, vx, vy;
+    std::vector<int32_t> health, max_health;
+    std::vector<ActionMask> input;
+    std::vector<int8_t> move_x;
+    std::vector<PlayerState> state;
+    std::vector<Facing> facing;
+    std::vector<uint8_t> flags;
+
+    size_t size() const { return flags.size(); }
+
+    void resize(size_t n) {
+        x.resize(n); y.resize(n); vx.resize(n); vy.resize(n);
+        health.resize(n); max_health.resize(n);
+        input.resize(n); move_x.resize(n);
+        state.resize(n); facing.resize(n);
+        flags.resize(n);
+    }
+
+    bool connected(size_t i) const { return (flags[i] & SIM_CONNECTED) != 0; }
+
+    // Fresh player defaults
+    void reset(size_t i) {
+        x[i] = 100.0f;
+        y[i] = physics::GROUND_Y;
+        vx[i] = 0.0f;
+        vy[i] = 0.0f;
+        health[i] = 100;
+        max_health[i] = 100;
+        input[i] = 0;
+        move_x[i] = 0;
+        state[i] = PlayerState::IDLE;
+        facing[i] = Facing::RIGHT;
+    }
+
+    void spawn(size_t i, float spawn_x, float spawn_y) {
+        x[i] = spawn_x;
+        y[i] = spawn_y;
+        vx[i] = 0;
+        vy[i] = 0;
+        health[i] = max_health[i];
+        state[i] = PlayerState::IDLE;
+    }
+
+    // Copies `n` lanes starting at `from` in `src` to lanes starting at `to`
+    void copy_lanes(size_t to, const SimStore& src, size_t from, size_t n) {
+        auto copy = [&](auto& dst_vec, const auto& src_vec) {
+            std::copy_n(src_vec.begin() + from, n, dst_vec.begin() + to);
+        };
+        copy(x, src.x); copy(y, src.y); copy(vx, src.vx); copy(vy, src.vy);
+        copy(health, src.health); copy(max_health, src.max_health);
+        copy(input, src.input); copy(move_x, src.move_x);
+        copy(state, src.state); copy(facing, src.facing);
+        copy(flags, src.flags);
+    }
+
+    void set_input(size_t i, PlayerInput in) {
+        input[i] = in.actions;
+        move_x[i] = in.move_x;
+    }
+
+    bool on_ground(size_t i) const {
+        return y[i] >= physics::GROUND_Y - 0.1f;
+    }
+};
+
+// ── Lane arena shared by many rooms ─────────────────
+// Rooms take a block of max_players lanes when created and give it back when
+// destroyed, so the batched physics step covers every playing room's players
+// in one pass over contiguous memory.
+class SimWorld {
+public:
+    SimStore lanes;
+
+    // Returns the first lane of a free block of `count` lanes (flags cleared)
+    size_t acquire(size_t count) {
+        for (auto it = free_.begin(); it != free_.end(); ++it) {
+            if (it->second < count) continue;
+            size_t base = it->first;
+            it->first += count;
+            it->second -= count;
+            if (it->second == 0) free_.erase(it);
+            return base;
+        }
+        size_t base = lanes.size();
+        lanes.resize(base + count);
+        return base;
+    }
+
+    void release(size_t base, size_t count) {
+        for (size_t i = base; i < base + count; ++i) lanes.flags[i] = 0;
+        free_.emplace_back(base, count);
+    }
+
+private:
+    std::vector<std::pair<size_t, size_t>> free_;  // (base, count)
+};
+
+namespace physics {
+
+// ── Physics update ──────────────────────────────────
+// Advances every lane in [begin, end) that is SIM_CONNECTED and SIM_ACTIVE
+// by dt and consumes its input. Vector kernels give bit-identical results to
+// the scalar one: same operations in the same order, no FMA contraction.
+// Implemented in game/physics.cpp.
+
+enum class Kernel : uint8_t { SCALAR, SSE41, AVX2 };
+
+std::string_view kernel_name(Kernel k);
+bool kernel_supported(Kernel k);
+
+// Widest kernel this CPU supports
+Kernel best_kernel();
+
+// Kernel used by step(). Process-wide; defaults to best_kernel(). Set once
+// at startup, before any simulation thread runs.
+Kernel kernel();
+void set_kernel(Kernel k);
+
+// "auto", "scalar", "sse4.1" or "avx2". Returns false (and leaves the
+// kernel unchanged) for unknown or unsupported names.
+bool select_kernel(std::string_view name);
+
+void step(SimStore& s, size_t begin, size_t end, float dt);
+
+// Explicit kernel, for benchmarks and comparisons; `k` must be supported
+void step_with(Kernel k, SimStore& s, size_t begin, size_t end, float dt);
+
+inline void step(SimStore& s, float dt) { step(s, 0, s.size(), dt); }
+
+} // namespace physics
+
+} // namespace game
@@ -2,6 +2,15 @@
 #include "utils/logger.h"
 #include "server/websocket_server.h"
 
+#include <csignal>
+
+// SIGTERM / SIGINT start a drain; a second one cuts it short
+static server::WebSocketServer* running_server = nullptr;
+
+extern "C" void on_stop_signal(int /*sig*/) {
+    if (running_server) running_server->request_drain();
+}
+
 int main() {
     auto cfg = config::ServerConfig::from_env();
     logger::set_level(cfg.log_level);
@@ -9,11 +18,25 @@ int main() {
     logger::info("=== WomboCombo Game Server v0.2.0 (Phase 2) ===");
     logger::info("port=" + std::to_string(cfg.port)
                  + " tick_rate=" + std::to_string(cfg.tick_rate)
+                 + " worker_threads=" + std::to_string(cfg.worker_threads)
+                 + " sim_workers=" + std::to_string(cfg.sim_workers)
+                 + " auth_workers=" + std::to_string(cfg.auth_workers)
                  + " log_level=" + cfg.log_level);
 
+    if (!game::physics::select_kernel(cfg.physics_kernel)) {
+        logger::warn("PHYSICS_KERNEL=" + cfg.physics_kernel + " not available here, using "
+                     + std::string(game::physics::kernel_name(game::physics::kernel())));
+    }
+    logger::info("physics kernel: " + std::string(game::physics::kernel_name(game::physics::kernel())));
+
     server::WebSocketServer ws_server(cfg);
+    running_server = &ws_server;
+    std::signal(SIGTERM, on_stop_signal);
+    std::signal(SIGINT, on_stop_signal);
+
     ws_server.run();
 
+    running_server = nullptr;
     logger::info("server stopped");
     return 0;
 }
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+#include "game/sim_store.h"
+
+namespace network {
+
+// ── Binary game_state snapshot (subprotocol wombocombo.bin.v1) ──────
+//
+// All integers little-endian. Positions/velocities are quantized to 1/10 px
+// (and 1/10 px/s), which is exactly the precision of the JSON encoding.
+//
+//   u8   kind          BIN_GAME_STATE
+//   u32  tick
+//   u16  time_left     1/10 s
+//   u8   round
+//   u8   player_count
+//   per player:
+//     u8   slot        index from lobby_state / game_start spawn_points
+//     i16  x, y        1/10 px
+//     i16  vx, vy      1/10 px/s
+//     i16  health
+//     u8   state (low nibble) | facing << 4
+//          state:  0 idle, 1 running, 2 jumping, 3 falling, 4 dead
+//          facing: 0 right, 1 left
+//
+// 12 bytes per player versus ~100 bytes of JSON.
+//
+// ── Delta snapshot (subprotocol wombocombo.delta.v1) ─────────────────
+//
+// Sent against the last tick the client acknowledged (snapshot_ack or the
+// "ack" field of player_input). Keyframes and stale baselines fall back to a
+// full BIN_GAME_STATE frame, which clients treat as a reset.
+//
+//   u8   kind          BIN_GAME_STATE_DELTA
+//   u32  tick
+//   u32  baseline_tick
+//   u16  time_left     1/10 s
+//   u8   round
+//   u8   changed_count
+//   per changed or new player:
+//     u8   slot
+//     u8   field mask  (DELTA_* bits below)
+//     i16  x, y, vx, vy, health   only the fields present in the mask, in order
+//     u8   state | facing << 4    if DELTA_STATE
+//   u8   removed_count
+//   u8   slot × removed_count
+
+constexpr uint8_t BIN_GAME_STATE       = 1;
+constexpr uint8_t BIN_GAME_STATE_DELTA = 2;
+
+constexpr uint8_t DELTA_X      = 1 << 0;
+constexpr uint8_t DELTA_Y      = 1 << 1;
+constexpr uint8_t DELTA_VX     = 1 << 2;
+constexpr uint8_t DELTA_VY     = 1 << 3;
+constexpr uint8_t DELTA_HEALTH = 1 << 4;
+constexpr uint8_t DELTA_STATE  = 1 << 5;
+constexpr uint8_t DELTA_ALL    = 0x3F;
+
+// One player as it appears on the wire, after quantization
+struct PlayerSnapshot {
+    uint8_t slot = 0;
+    int16_t x = 0, y = 0, vx = 0, vy = 0;
+    int16_t health = 0;
+    uint8_t state_facing = 0;
+};
+
+namespace binary {
+
+inline void put_u8(std::string& out, uint8_t v) {
+    out.push_back(static_cast<char>(v));
+}
+
+inline void put_u16(std::string& out, uint16_t v) {
+    out.push_back(static_cast<char>(v & 0xFF));
+    out.push_back(static_cast<char>(v >> 8));
+}
+
+inline void put_i16(std::string& out, int16_t v) {
+    put_u16(out, static_cast<uint16_t>(v));
+}
+
+inline void put_u32(std::string& out, uint32_t v) {
+    put_u16(out, static_cast<uint16_t>(v & 0xFFFF));
+    put_u16(out, static_cast<uint16_t>(v >> 16));
+}
+
+} // namespace binary
+
+// Seat `slot`, simulated in `lane` of the store
+inline PlayerSnapshot quantize_lane(const game::SimStore& sim, size_t lane, size_t slot) {
+    return {
+        static_cast<uint8_t>(slot),
+        game::quantize(sim.x[lane]),
+        game::quantize(sim.y[lane]),
+        game::quantize(sim.vx[lane]),
+        game::quantize(sim.vy[lane]),
+        static_cast<int16_t>(std::clamp(sim.health[lane], -32768, 32767)),
+        static_cast<uint8_t>(static_cast<uint8_t>(sim.state[lane])
+                             | (static_cast<uint8_t>(sim.facing[lane]) << 4))
+    };
+}
+
+inline void encode_header(std::string& out, uint8_t kind, int tick) {
+    binary::put_u8(out, kind);
+    binary::put_u32(out, static_cast<uint32_t>(tick));
+}
+
+inline void encode_round_info(std::string& out, float time_left, int round) {
+    binary::put_u16(out, static_cast<uint16_t>(std::max<int16_t>(game::quantize(time_left), 0)));
+    binary::put_u8(out, static_cast<uint8_t>(round));
+}
+
+// Full snapshot. `players` must be sorted by slot.
+inline void encode_game_state(std::string& out, int tick, float time_left, int round,
+                              const std::vector<PlayerSnapshot>& players) {
+    encode_header(out, BIN_GAME_STATE, tick);
+    encode_round_info(out, time_left, round);
+    binary::put_u8(out, static_cast<uint8_t>(players.size()));
+    for (const auto& p : players) {
+        binary::put_u8(out, p.slot);
+        binary::put_i16(out, p.x);
+        binary::put_i16(out, p.y);
+        binary::put_i16(out, p.vx);
+        binary::put_i16(out, p.vy);
+        binary::put_i16(out, p.health);
+        binary::put_u8(out, p.state_facing);
+    }
+}
+
+inline uint8_t delta_mask(const PlayerSnapshot& base, const PlayerSnapshot& cur) {
+    uint8_t mask = 0;
+    if (base.x != cur.x)                       mask |= DELTA_X;
+    if (base.y != cur.y)                       mask |= DELTA_Y;
+    if (base.vx != cur.vx)                     mask |= DELTA_VX;
+    if (base.vy != cur.vy)                     mask |= DELTA_VY;
+    if (base.health != cur.health)             mask |= DELTA_HEALTH;
+    if (base.state_facing != cur.state_facing) mask |= DELTA_STATE;
+    return mask;
+}
+
+// Delta snapshot against `baseline`. Both lists must be sorted by slot.
+inline void encode_game_state_delta(std::string& out, int tick, int baseline_tick,
+                                    float time_left, int round,
+                                    const std::vector<PlayerSnapshot>& baseline,
+                                    const std::vector<PlayerSnapshot>& current) {
+    encode_header(out, BIN_GAME_STATE_DELTA, tick);
+    binary::put_u32(out, static_cast<uint32_t>(baseline_tick));
+    encode_round_info(out, time_left, round);
+
+    // Patched once the changed players are known
+    size_t count_pos = out.size();
+    binary::put_u8(out, 0);
+
+    uint8_t changed = 0;
+    size_t b = 0;
+    for (const auto& cur : current) {
+        while (b < baseline.size() && baseline[b].slot < cur.slot) ++b;
+        bool known = b < baseline.size() && baseline[b].slot == cur.slot;
+
+        uint8_t mask = known ? delta_mask(baseline[b], cur) : DELTA_ALL;
+        if (mask == 0) continue;
+
+        binary::put_u8(out, cur.slot);
+        binary::put_u8(out, mask);
+        if (mask & DELTA_X)      binary::put_i16(out, cur.x);
+        if (mask & DELTA_Y)      binary::put_i16(out, cur.y);
+        if (mask & DELTA_VX)     binary::put_i16(out, cur.vx);
+        if (mask & DELTA_VY)     binary::put_i16(out, cur.vy);
+        if (mask & DELTA_HEALTH) binary::put_i16(out, cur.health);
+        if (mask & DELTA_STATE)  binary::put_u8(out, cur.state_facing);
+        ++changed;
+    }
+    out[count_pos] = static_cast<char>(changed);
+
+    // Players present in the baseline but gone now
+    count_pos = out.size();
+    binary::put_u8(out, 0);
+
+    uint8_t removed = 0;
+    size_t c = 0;
+    for (const auto& base : baseline) {
+        while (c < current.size() && current[c].slot < base.slot) ++c;
+        if (c < current.size() && current[c].slot == base.slot) continue;
+        binary::put_u8(out, base.slot);
+        ++removed;
+    }
+    out[count_pos] = static_cast<char>(removed);
+}
+
+} // namespace network
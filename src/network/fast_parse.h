@@ -0,0 +1,272 @@
+#pragma once
+
+#include <string_view>
+#include <charconv>
+#include <cstdint>
+#include <climits>
+
+#include "game/input.h"
+
+namespace network {
+
+// ── Zero-copy parser for hot inbound messages ───────────────────────
+//
+// player_input, snapshot_ack and ping arrive dozens of times per second per
+// player. This scans the raw frame uWS hands us and pulls out the few fields
+// those messages carry — actions are folded straight into a PlayerInput
+// bitmask as they are scanned. No DOM, no copies.
+//
+// Anything it isn't sure about (other types, escaped strings, non-integer
+// ticks, malformed input) returns false and the caller
+// falls back to parse_message() + handle_message(), which keeps error
+// reporting and edge-case semantics exactly as before.
+
+struct FastMessage {
+    enum class Kind { PING, PLAYER_INPUT, SNAPSHOT_ACK };
+
+    Kind kind = Kind::PING;
+    bool has_tick = false;
+    int tick = 0;
+    bool has_ack = false;
+    int ack = 0;
+    game::PlayerInput input;
+};
+
+namespace detail {
+
+inline bool to_int(std::string_view text, int& out) {
+    int64_t v = 0;
+    auto res = std::from_chars(text.data(), text.data() + text.size(), v);
+    if (res.ec != std::errc() || res.ptr != text.data() + text.size()) return false;
+    if (v < INT_MIN || v > INT_MAX) return false;
+    out = static_cast<int>(v);
+    return true;
+}
+
+class Scanner {
+public:
+    explicit Scanner(std::string_view s) : p_(s.data()), end_(s.data() + s.size()) {}
+
+    void ws() {
+        while (p_ < end_ && (*p_ == ' ' || *p_ == '\t' || *p_ == '\n' || *p_ == '\r')) ++p_;
+    }
+
+    bool at_end() const { return p_ == end_; }
+    bool peek(char c) const { return p_ < end_ && *p_ == c; }
+    bool peek_number() const { return p_ < end_ && (*p_ == '-' || (*p_ >= '0' && *p_ <= '9')); }
+
+    bool consume(char c) {
+        ws();
+        if (!peek(c)) return false;
+        ++p_;
+        return true;
+    }
+
+    // String without escapes, as a view into the frame. `escaped` is set
+    // (and false returned) if the string needs unescaping.
+    bool string(std::string_view& out, bool& escaped) {
+        escaped = false;
+        ws();
+        if (!peek('"')) return false;
+        const char* start = ++p_;
+        while (p_ < end_ && *p_ != '"') {
+            if (*p_ == '\\') { escaped = true; return false; }
+            if (static_cast<unsigned char>(*p_) < 0x20) return false;
+            ++p_;
+        }
+        if (p_ == end_) return false;
+        out = std::string_view(start, p_ - start);
+        ++p_;
+        return true;
+    }
+
+    // JSON number; `integral` is false for fractions/exponents
+    bool number(std::string_view& out, bool& integral) {
+        ws();
+        const char* start = p_;
+        integral = true;
+        if (peek('-')) ++p_;
+        if (peek('0')) {
+            ++p_;
+        } else if (p_ < end_ && *p_ >= '1' && *p_ <= '9') {
+            while (p_ < end_ && *p_ >= '0' && *p_ <= '9') ++p_;
+        } else {
+            return false;
+        }
+        if (peek('.')) {
+            integral = false;
+            ++p_;
+            if (!digits()) return false;
+        }
+        if (peek('e') || peek('E')) {
+            integral = false;
+            ++p_;
+            if (peek('+') || peek('-')) ++p_;
+            if (!digits()) return false;
+        }
+        out = std::string_view(start, p_ - start);
+        return true;
+    }
+
+    bool integer(int& out) {
+        std::string_view text;
+        bool integral = false;
+        return number(text, integral) && integral && to_int(text, out);
+    }
+
+    bool skip_value(int depth = 0) {
+        if (depth > 32) return false;
+        ws();
+        if (p_ == end_) return false;
+
+        std::string_view sv;
+        bool flag = false;
+        switch (*p_) {
+            case '"':
+                if (string(sv, flag)) return true;
+                return flag && skip_escaped_string();
+            case '{': {
+                ++p_;
+                if (consume('}')) return true;
+                do {
+                    if (!string(sv, flag) && !(flag && skip_escaped_string())) return false;
+                    if (!consume(':') || !skip_value(depth + 1)) return false;
+                } while (consume(','));
+                return consume('}');
+            }
+            case '[': {
+                ++p_;
+                if (consume(']')) return true;
+                do {
+                    if (!skip_value(depth + 1)) return false;
+                } while (consume(','));
+                return consume(']');
+            }
+            case 't': return literal("true");
+            case 'f': return literal("false");
+            case 'n': return literal("null");
+            default:  return number(sv, flag);
+        }
+    }
+
+private:
+    bool digits() {
+        const char* start = p_;
+        while (p_ < end_ && *p_ >= '0' && *p_ <= '9') ++p_;
+        return p_ != start;
+    }
+
+    bool literal(std::string_view word) {
+        if (static_cast<size_t>(end_ - p_) < word.size()) return false;
+        if (std::string_view(p_, word.size()) != word) return false;
+        p_ += word.size();
+        return true;
+    }
+
+    // Called with p_ on the first backslash of an open string
+    bool skip_escaped_string() {
+        while (p_ < end_ && *p_ != '"') {
+            if (*p_ == '\\') {
+                if (++p_ == end_) return false;
+            }
+            ++p_;
+        }
+        if (p_ == end_) return false;
+        ++p_;
+        return true;
+    }
+
+    const char* p_;
+    const char* end_;
+};
+
+} // namespace detail
+
+// Returns true and fills `out` if `raw` is a well-formed hot message.
+inline bool parse_fast(std::string_view raw, FastMessage& out) {
+    detail::Scanner sc(raw);
+    std::string_view type;
+    std::string_view key;
+    bool escaped = false;
+
+    if (!sc.consume('{')) return false;
+    if (sc.consume('}')) return false;  // no type — let the slow path report it
+
+    do {
+        if (!sc.string(key, escaped) || !sc.consume(':')) return false;
+
+        if (key == "type") {
+            if (!sc.string(type, escaped)) return false;
+        } else if (key == "tick") {
+            if (!sc.integer(out.tick)) return false;
+            out.has_tick = true;
+        } else if (key == "ack") {
+            // Only integer acks count, same as handle_message()
+            sc.ws();
+            out.has_ack = false;
+            if (sc.peek_number()) {
+                std::string_view text;
+                bool integral = false;
+                if (!sc.number(text, integral)) return false;
+                if (integral) {
+                    if (!detail::to_int(text, out.ack)) return false;
+                    out.has_ack = true;
+                }
+            } else if (!sc.skip_value()) {
+                return false;
+            }
+        } else if (key == "move_x") {
+            // Non-numbers are ignored, as in handle_message()
+            sc.ws();
+            if (sc.peek_number()) {
+                std::string_view text;
+                bool integral = false;
+                float axis = 0.0f;
+                if (!sc.number(text, integral)) return false;
+                auto res = std::from_chars(text.data(), text.data() + text.size(), axis);
+                if (res.ec != std::errc()) return false;
+                out.input.move_x = 0;
+                out.input.set_move_x(axis);
+            } else {
+                out.input.move_x = 0;
+                if (!sc.skip_value()) return false;
+            }
+        } else if (key == "actions") {
+            sc.ws();
+            out.input.actions = 0;
+            if (!sc.peek('[')) {
+                if (!sc.skip_value()) return false;
+                continue;
+            }
+            sc.consume('[');
+            if (sc.consume(']')) continue;
+            do {
+                sc.ws();
+                if (sc.peek('"')) {
+                    std::string_view action;
+                    if (!sc.string(action, escaped)) return false;
+                    out.input.add_action(action);
+                } else {
+                    // Non-string entries are ignored, as in handle_message()
+                    if (!sc.skip_value()) return false;
+                }
+            } while (sc.consume(','));
+            if (!sc.consume(']')) return false;
+        } else if (!sc.skip_value()) {
+            return false;
+        }
+    } while (sc.consume(','));
+
+    if (!sc.consume('}')) return false;
+    sc.ws();
+    if (!sc.at_end()) return false;
+
+    if (type == "player_input")      out.kind = FastMessage::Kind::PLAYER_INPUT;
+    else if (type == "snapshot_ack") out.kind = FastMessage::Kind::SNAPSHOT_ACK;
+    else if (type == "ping")         out.kind = FastMessage::Kind::PING;
+    else return false;
+
+    return true;
+}
+
+} // namespace network
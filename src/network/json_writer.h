@@ -0,0 +1,116 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <charconv>
+#include <vector>
+#include <cstdint>
+
+#include "game/player.h"
+#include "game/sim_store.h"
+
+namespace network {
+
+// ── Streaming JSON for the tick path ────────────────────────────────
+//
+// Appends tokens straight into a caller-owned buffer — no DOM, no
+// temporaries. Callers clear() the buffer between messages so its capacity
+// is reused and steady-state ticks don't touch the heap.
+//
+// Output is byte-identical to the nlohmann tree it replaces
+// (Room::game_state() + dump()). nlohmann objects are std::map-backed, so
+// keys are written in sorted order here.
+
+namespace json {
+
+inline void append_int(std::string& out, int64_t v) {
+    char buf[24];
+    auto res = std::to_chars(buf, buf + sizeof(buf), v);
+    out.append(buf, res.ptr);
+}
+
+// A value quantized to 1/10 (see game::quantize), printed the way nlohmann
+// prints the double q / 10.0: "-385.3", "672.0", "0.5".
+inline void append_decis(std::string& out, int16_t q) {
+    int v = q;
+    if (v < 0) {
+        out.push_back('-');
+        v = -v;
+    }
+    append_int(out, v / 10);
+    out.push_back('.');
+    out.push_back(static_cast<char>('0' + v % 10));
+}
+
+// Same escaping as nlohmann's dump() with ensure_ascii = false
+inline void append_string(std::string& out, std::string_view s) {
+    static constexpr char hex[] = "0123456789abcdef";
+    out.push_back('"');
+    for (char c : s) {
+        auto u = static_cast<unsigned char>(c);
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b";  break;
+            case '\f': out += "\\f";  break;
+            case '\n': out += "\\n";  break;
+            case '\r': out += "\\r";  break;
+            case '\t': out += "\\t";  break;
+            default:
+                if (u < 0x20) {
+                    out += "\\u00";
+                    out.push_back(hex[u >> 4]);
+                    out.push_back(hex[u & 0xF]);
+                } else {
+                    out.push_back(c);
+                }
+        }
+    }
+    out.push_back('"');
+}
+
+} // namespace json
+
+inline void write_player_json(std::string& out, std::string_view id,
+                              const game::SimStore& sim, size_t lane) {
+    out += "{\"facing\":";
+    json::append_string(out, game::to_string(sim.facing[lane]));
+    out += ",\"health\":";
+    json::append_int(out, sim.health[lane]);
+    out += ",\"id\":";
+    json::append_string(out, id);
+    out += ",\"state\":";
+    json::append_string(out, game::to_string(sim.state[lane]));
+    out += ",\"vx\":";
+    json::append_decis(out, game::quantize(sim.vx[lane]));
+    out += ",\"vy\":";
+    json::append_decis(out, game::quantize(sim.vy[lane]));
+    out += ",\"x\":";
+    json::append_decis(out, game::quantize(sim.x[lane]));
+    out += ",\"y\":";
+    json::append_decis(out, game::quantize(sim.y[lane]));
+    out.push_back('}');
+}
+
+// Connected players in slot order; seat `slot` is simulated in lane base + slot
+inline void write_game_state_json(std::string& out, int tick, float time_left, int round,
+                                  const std::vector<game::Player>& seats,
+                                  const game::SimStore& sim, size_t base = 0) {
+    out += "{\"enemies\":[],\"items\":[],\"players\":[";
+    bool first = true;
+    for (size_t slot = 0; slot < seats.size(); ++slot) {
+        if (!sim.connected(base + slot)) continue;
+        if (!first) out.push_back(',');
+        first = false;
+        write_player_json(out, seats[slot].id, sim, base + slot);
+    }
+    out += "],\"round\":";
+    json::append_int(out, round);
+    out += ",\"tick\":";
+    json::append_int(out, tick);
+    out += ",\"time_left\":";
+    json::append_decis(out, game::quantize(time_left));
+    out += ",\"type\":\"game_state\"}";
+}
+
+} // namespace network
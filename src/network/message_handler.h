@@ -5,61 +5,81 @@
 
 #include "game/room.h"
 #include "network/protocol.h"
+#include "network/fast_parse.h"
 #include "utils/logger.h"
 
 namespace network {
 
 // Handles a single parsed message from a player inside a room.
+// `player_id` is the handle's string form, only used for logging.
 // Returns false if the message type is unrecognized (non-fatal).
 inline bool handle_message(game::Room& room,
+                           game::PlayerHandle player,
                            const std::string& player_id,
                            const nlohmann::json& msg) {
     std::string type = get_type(msg);
     if (type.empty()) {
-        room.send_to(player_id, make_error(400, "Missing or invalid 'type' field"));
+        room.send_to(player, make_error(400, "Missing or invalid 'type' field"));
         return false;
     }
 
     // ── Heartbeat ───────────────────────────────
     if (type == "ping") {
-        room.send_to(player_id, {{"type", "pong"}});
+        room.send_to(player, {{"type", "pong"}});
         return true;
     }
 
     // ── Lobby messages ────────────────────────────
     if (type == "player_ready") {
         bool ready = msg.value("ready", false);
-        room.set_player_ready(player_id, ready);
+        room.set_player_ready(player, ready);
         return true;
     }
 
     if (type == "chat_message") {
         std::string message = msg.value("message", "");
         if (message.empty()) {
-            room.send_to(player_id, make_error(400, "Empty chat message"));
+            room.send_to(player, make_error(400, "Empty chat message"));
             return false;
         }
         if (message.size() > 200) {
             message = message.substr(0, 200);
         }
-        room.handle_chat(player_id, message);
+        room.handle_chat(player, message);
         return true;
     }
 
     // ── Gameplay messages ─────────────────────────
     if (type == "player_input") {
-        int tick = msg.value("tick", 0);
+        // Read by type: value() would throw on e.g. a string tick
+        int tick = msg.contains("tick") && msg["tick"].is_number_integer() ? msg["tick"].get<int>() : 0;
 
-        std::vector<std::string> actions;
+        game::PlayerInput input;
         if (msg.contains("actions") && msg["actions"].is_array()) {
             for (const auto& a : msg["actions"]) {
                 if (a.is_string()) {
-                    actions.push_back(a.get<std::string>());
+                    input.add_action(a.get_ref<const std::string&>());
                 }
             }
         }
+        if (msg.contains("move_x") && msg["move_x"].is_number()) {
+            input.set_move_x(msg["move_x"].get<float>());
+        }
+
+        room.queue_input(player, tick, input);
+
+        // Delta clients piggyback their snapshot ack on input
+        if (msg.contains("ack") && msg["ack"].is_number_integer()) {
+            room.ack_snapshot(player, msg["ack"].get<int>());
+        }
+        return true;
+    }
 
-        room.queue_input(player_id, tick, actions);
+    if (type == "snapshot_ack") {
+        // Only integer ticks count, as for the ack on player_input
+        if (msg.contains("tick") && msg["tick"].is_number_integer()) {
+            room.ack_snapshot(player, msg["tick"].get<int>());
+        }
         return true;
     }
 
@@ -77,8 +97,29 @@ inline bool handle_message(game::Room& room,
 
     // Unknown message type — log but don't spam the client
     logger::warn("unknown message type '" + type + "' from player " + player_id);
-    room.send_to(player_id, make_error(400, "Unknown message type: " + type));
+    room.send_to(player, make_error(400, "Unknown message type: " + type));
     return false;
 }
 
+// Handles a message already decoded by parse_fast() — same behavior as
+// handle_message() for those types, without building a DOM.
+inline void handle_fast_message(game::Room& room,
+                                game::PlayerHandle player,
+                                const FastMessage& msg) {
+    switch (msg.kind) {
+        case FastMessage::Kind::PING:
+            room.send_to(player, {{"type", "pong"}});
+            break;
+
+        case FastMessage::Kind::PLAYER_INPUT:
+            room.queue_input(player, msg.has_tick ? msg.tick : 0, msg.input);
+            if (msg.has_ack) room.ack_snapshot(player, msg.ack);
+            break;
+
+        case FastMessage::Kind::SNAPSHOT_ACK:
+            room.ack_snapshot(player, msg.has_tick ? msg.tick : -1);
+            break;
+    }
+}
+
 } // namespace network
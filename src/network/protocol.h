@@ -46,13 +46,16 @@ inline nlohmann::json make_connected(const std::string& player_id,
     };
 }
 
-// Build player_joined event
+// Build player_joined event. `slot` maps the player to their lane in
+// binary and delta snapshots, for clients already past lobby_state.
 inline nlohmann::json make_player_joined(const std::string& player_id,
-                                          const std::string& player_name) {
+                                          const std::string& player_name,
+                                          int slot) {
     return {
         {"type", "player_joined"},
         {"player_id", player_id},
-        {"player_name", player_name}
+        {"player_name", player_name},
+        {"slot", slot}
     };
 }
 
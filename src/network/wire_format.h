@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string_view>
+#include <cstdint>
+
+namespace network {
+
+// Encoding used for game_state snapshots on a given connection.
+// Everything else (lobby, chat, errors) is always JSON text.
+enum class WireFormat : uint8_t {
+    JSON,          // default — TEXT frames, same as Phase 2 clients expect
+    BINARY,        // compact binary snapshots (see network/binary_codec.h)
+    BINARY_DELTA   // binary, delta-compressed against the client's last ack
+};
+
+// Sec-WebSocket-Protocol tokens a client offers to opt into binary snapshots
+constexpr std::string_view SUBPROTOCOL_BINARY       = "wombocombo.bin.v1";
+constexpr std::string_view SUBPROTOCOL_BINARY_DELTA = "wombocombo.delta.v1";
+
+struct NegotiatedProtocol {
+    WireFormat format = WireFormat::JSON;
+    std::string_view accepted;  // value echoed back in the handshake response
+};
+
+// Pick the wire format from the client's Sec-WebSocket-Protocol header
+// (comma separated list, first known token wins). Unknown offers fall back to
+// JSON and the header is echoed back untouched, exactly as before
+// subprotocols were negotiated.
+inline NegotiatedProtocol negotiate_wire_format(std::string_view offered) {
+    std::string_view rest = offered;
+    while (!rest.empty()) {
+        auto comma = rest.find(',');
+        auto token = rest.substr(0, comma);
+        rest = (comma == std::string_view::npos) ? std::string_view{} : rest.substr(comma + 1);
+
+        while (!token.empty() && token.front() == ' ') token.remove_prefix(1);
+        while (!token.empty() && token.back() == ' ') token.remove_suffix(1);
+
+        if (token == SUBPROTOCOL_BINARY) {
+            return {WireFormat::BINARY, SUBPROTOCOL_BINARY};
+        }
+        if (token == SUBPROTOCOL_BINARY_DELTA) {
+            return {WireFormat::BINARY_DELTA, SUBPROTOCOL_BINARY_DELTA};
+        }
+    }
+    return {WireFormat::JSON, offered};
+}
+
+} // namespace network
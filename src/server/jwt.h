@@ -3,12 +3,14 @@
 #include <string>
 #include <string_view>
 #include <optional>
-#include <vector>
+#include <array>
+#include <memory>
 #include <cstdint>
+#include <cstring>
 #include <ctime>
 #include <nlohmann/json.hpp>
-#include <openssl/hmac.h>
 #include <openssl/evp.h>
+#include <openssl/crypto.h>
 
 #include "utils/logger.h"
 
@@ -23,91 +25,195 @@ struct JwtPayload {
 
 namespace detail {
 
-// Base64url alphabet → value lookup table
-inline int b64_val(char c) {
-    if (c >= 'A' && c <= 'Z') return c - 'A';
-    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
-    if (c >= '0' && c <= '9') return c - '0' + 52;
-    if (c == '-' || c == '+') return 62;
-    if (c == '_' || c == '/') return 63;
-    return -1;
+// ── base64url ───────────────────────────────────────
+// Character → 6-bit value, 0xFF outside the alphabet. Accepts the standard
+// alphabet's '+' and '/' too.
+inline constexpr auto B64_TABLE = [] {
+    std::array<uint8_t, 256> t{};
+    t.fill(0xFF);
+    for (int i = 0; i < 26; ++i) {
+        t['A' + i] = static_cast<uint8_t>(i);
+        t['a' + i] = static_cast<uint8_t>(26 + i);
+    }
+    for (int i = 0; i < 10; ++i) t['0' + i] = static_cast<uint8_t>(52 + i);
+    t['-'] = t['+'] = 62;
+    t['_'] = t['/'] = 63;
+    return t;
+}();
+
+inline constexpr size_t base64url_decoded_size(size_t chars) {
+    return chars / 4 * 3 + (chars % 4 == 0 ? 0 : chars % 4 - 1);
 }
 
-inline std::vector<uint8_t> base64url_decode(std::string_view input) {
-    std::vector<uint8_t> out;
-    out.reserve(input.size() * 3 / 4);
-
-    uint32_t buf = 0;
-    int bits = 0;
-
-    for (char c : input) {
-        if (c == '=' || c == ' ' || c == '\n') continue;
-        int val = b64_val(c);
-        if (val < 0) continue;
-        buf = (buf << 6) | val;
-        bits += 6;
-        if (bits >= 8) {
-            bits -= 8;
-            out.push_back(static_cast<uint8_t>((buf >> bits) & 0xFF));
-        }
+// Decodes into `out`, which must hold base64url_decoded_size(input.size())
+// bytes. Four characters at a time through B64_TABLE, with one validity
+// check per group instead of a branch per character. Trailing '=' padding
+// is ignored; any other character outside the alphabet, or an impossible
+// length, fails. Returns the decoded length, or -1.
+inline int base64url_decode(std::string_view input, uint8_t* out) {
+    while (!input.empty() && input.back() == '=') input.remove_suffix(1);
+    if (input.size() % 4 == 1) return -1;
+
+    const auto* in = reinterpret_cast<const unsigned char*>(input.data());
+    size_t n = input.size();
+    uint8_t* o = out;
+    uint8_t bad = 0;
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        uint8_t a = B64_TABLE[in[i]], b = B64_TABLE[in[i + 1]];
+        uint8_t c = B64_TABLE[in[i + 2]], d = B64_TABLE[in[i + 3]];
+        bad |= a | b | c | d;
+        uint32_t v = (uint32_t(a) << 18) | (uint32_t(b) << 12) | (uint32_t(c) << 6) | d;
+        o[0] = static_cast<uint8_t>(v >> 16);
+        o[1] = static_cast<uint8_t>(v >> 8);
+        o[2] = static_cast<uint8_t>(v);
+        o += 3;
+    }
+    if (size_t rest = n - i; rest >= 2) {
+        uint8_t a = B64_TABLE[in[i]], b = B64_TABLE[in[i + 1]];
+        uint8_t c = rest == 3 ? B64_TABLE[in[i + 2]] : 0;
+        bad |= a | b | c;
+        uint32_t v = (uint32_t(a) << 18) | (uint32_t(b) << 12) | (uint32_t(c) << 6);
+        *o++ = static_cast<uint8_t>(v >> 16);
+        if (rest == 3) *o++ = static_cast<uint8_t>(v >> 8);
     }
-    return out;
+    // Every valid value is < 64, so any 0xFF shows up in the high bits
+    if (bad & 0xC0) return -1;
+    return static_cast<int>(o - out);
 }
 
-inline std::string base64url_decode_str(std::string_view input) {
-    auto bytes = base64url_decode(input);
-    return std::string(bytes.begin(), bytes.end());
-}
+} // namespace detail
 
-inline std::vector<uint8_t> hmac_sha256(std::string_view key, std::string_view data) {
-    unsigned char result[EVP_MAX_MD_SIZE];
-    unsigned int len = 0;
+// ── Pre-keyed HMAC-SHA256 ───────────────────────────
+// One-shot HMAC() fetches SHA-256 and hashes the key's inner and outer pads
+// on every call. HmacKey does that once per secret and keeps the two
+// digest states; sign() copies them into a per-thread scratch context, so a
+// verification costs two short hashes and no allocation. A key is
+// read-only after construction and safe to share between threads.
+class HmacKey {
+public:
+    static constexpr size_t DIGEST_SIZE = 32;
+
+    HmacKey() = default;
+
+    explicit HmacKey(std::string_view secret) {
+        EVP_MD* md = EVP_MD_fetch(nullptr, "SHA256", nullptr);
+        if (!md) return;
+
+        // Keys longer than the block are hashed first, as HMAC does
+        constexpr size_t BLOCK = 64;
+        unsigned char key[BLOCK] = {};
+        if (secret.size() > BLOCK) {
+            unsigned int len = 0;
+            EVP_Digest(secret.data(), secret.size(), key, &len, md, nullptr);
+        } else {
+            std::memcpy(key, secret.data(), secret.size());
+        }
+
+        unsigned char ipad[BLOCK], opad[BLOCK];
+        for (size_t i = 0; i < BLOCK; ++i) {
+            ipad[i] = key[i] ^ 0x36;
+            opad[i] = key[i] ^ 0x5c;
+        }
 
-    HMAC(EVP_sha256(),
-         key.data(), static_cast<int>(key.size()),
-         reinterpret_cast<const unsigned char*>(data.data()), data.size(),
-         result, &len);
+        inner_.reset(EVP_MD_CTX_new());
+        outer_.reset(EVP_MD_CTX_new());
+        bool ok = inner_ && outer_
+            && EVP_DigestInit_ex(inner_.get(), md, nullptr) && EVP_DigestUpdate(inner_.get(), ipad, BLOCK)
+            && EVP_DigestInit_ex(outer_.get(), md, nullptr) && EVP_DigestUpdate(outer_.get(), opad, BLOCK);
+        OPENSSL_cleanse(key, BLOCK);
+        OPENSSL_cleanse(ipad, BLOCK);
+        OPENSSL_cleanse(opad, BLOCK);
+        EVP_MD_free(md);
+        if (!ok) {
+            inner_.reset();
+            outer_.reset();
+        }
+    }
+
+    bool valid() const { return inner_ != nullptr; }
+
+    // HMAC-SHA256(secret, data) into `out`; false if the key is unusable
+    bool sign(std::string_view data, unsigned char (&out)[DIGEST_SIZE]) const {
+        if (!valid()) return false;
+        thread_local CtxPtr scratch(EVP_MD_CTX_new());
+        if (!scratch) return false;
+
+        unsigned int len = 0;
+        return EVP_MD_CTX_copy_ex(scratch.get(), inner_.get())
+            && EVP_DigestUpdate(scratch.get(), data.data(), data.size())
+            && EVP_DigestFinal_ex(scratch.get(), out, &len)
+            && EVP_MD_CTX_copy_ex(scratch.get(), outer_.get())
+            && EVP_DigestUpdate(scratch.get(), out, len)
+            && EVP_DigestFinal_ex(scratch.get(), out, &len);
+    }
+
+private:
+    struct CtxFree {
+        void operator()(EVP_MD_CTX* ctx) const { EVP_MD_CTX_free(ctx); }
+    };
+    using CtxPtr = std::unique_ptr<EVP_MD_CTX, CtxFree>;
+
+    CtxPtr inner_;  // SHA-256 state after key ^ ipad
+    CtxPtr outer_;  // SHA-256 state after key ^ opad
+};
+
+namespace detail {
+
+// Whether `signature_b64` is HMAC-SHA256(key, signed_part)
+inline bool signature_matches(std::string_view signed_part, std::string_view signature_b64,
+                              const HmacKey& key) {
+    unsigned char expected_sig[HmacKey::DIGEST_SIZE];
+    if (!key.sign(signed_part, expected_sig)) {
+        logger::warn("JWT signing key unusable");
+        return false;
+    }
 
-    return std::vector<uint8_t>(result, result + len);
+    uint8_t actual_sig[HmacKey::DIGEST_SIZE + 3];
+    if (base64url_decoded_size(signature_b64.size()) > sizeof(actual_sig)
+        || base64url_decode(signature_b64, actual_sig) != static_cast<int>(HmacKey::DIGEST_SIZE)) {
+        return false;
+    }
+
+    // Constant-time comparison to prevent timing attacks
+    return CRYPTO_memcmp(expected_sig, actual_sig, HmacKey::DIGEST_SIZE) == 0;
 }
 
 } // namespace detail
 
-// Validate a JWT token against a secret key.
+// Validate a JWT token against a pre-keyed secret, or, failing that, against
+// `previous` (the secret being rotated out) when given.
 // Returns the payload if valid, nullopt if invalid/expired.
-inline std::optional<JwtPayload> validate_jwt(const std::string& token,
-                                               const std::string& secret) {
+inline std::optional<JwtPayload> validate_jwt(std::string_view token, const HmacKey& key,
+                                              const HmacKey* previous) {
     // Split into header.payload.signature
     auto dot1 = token.find('.');
-    if (dot1 == std::string::npos) return std::nullopt;
+    if (dot1 == std::string_view::npos) return std::nullopt;
     auto dot2 = token.find('.', dot1 + 1);
-    if (dot2 == std::string::npos) return std::nullopt;
+    if (dot2 == std::string_view::npos) return std::nullopt;
 
-    std::string_view header_b64 = std::string_view(token).substr(0, dot1);
-    std::string_view payload_b64 = std::string_view(token).substr(dot1 + 1, dot2 - dot1 - 1);
-    std::string_view signature_b64 = std::string_view(token).substr(dot2 + 1);
+    std::string_view payload_b64 = token.substr(dot1 + 1, dot2 - dot1 - 1);
+    std::string_view signature_b64 = token.substr(dot2 + 1);
 
     // Verify signature: HMAC-SHA256(header.payload, secret)
-    std::string_view signed_part = std::string_view(token).substr(0, dot2);
-    auto expected_sig = detail::hmac_sha256(secret, signed_part);
-    auto actual_sig = detail::base64url_decode(signature_b64);
-
-    if (expected_sig.size() != actual_sig.size()) return std::nullopt;
-
-    // Constant-time comparison to prevent timing attacks
-    unsigned char diff = 0;
-    for (size_t i = 0; i < expected_sig.size(); ++i) {
-        diff |= expected_sig[i] ^ actual_sig[i];
-    }
-    if (diff != 0) {
+    if (!detail::signature_matches(token.substr(0, dot2), signature_b64, key)
+        && !(previous && detail::signature_matches(token.substr(0, dot2), signature_b64, *previous))) {
         logger::warn("JWT signature verification failed");
         return std::nullopt;
     }
 
-    // Decode payload
-    std::string payload_json = detail::base64url_decode_str(payload_b64);
+    // Decode payload into a stack buffer; our tokens carry a few claims
+    uint8_t payload_buf[1024];
+    if (detail::base64url_decoded_size(payload_b64.size()) > sizeof(payload_buf)) {
+        logger::warn("JWT payload too large");
+        return std::nullopt;
+    }
+    int payload_len = detail::base64url_decode(payload_b64, payload_buf);
+    if (payload_len < 0) return std::nullopt;
+
     try {
-        auto payload = nlohmann::json::parse(payload_json);
+        auto payload = nlohmann::json::parse(payload_buf, payload_buf + payload_len);
 
         JwtPayload result;
         result.sub = payload.value("sub", "");
@@ -134,4 +240,14 @@ inline std::optional<JwtPayload> validate_jwt(const std::string& token,
     }
 }
 
+inline std::optional<JwtPayload> validate_jwt(std::string_view token, const HmacKey& key) {
+    return validate_jwt(token, key, nullptr);
+}
+
+// Same, keying HMAC from the secret on every call
+inline std::optional<JwtPayload> validate_jwt(const std::string& token,
+                                               const std::string& secret) {
+    return validate_jwt(token, HmacKey(secret));
+}
+
 } // namespace auth
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "server/jwt.h"
+
+namespace auth {
+
+// ── JWT secrets in rotation ─────────────────────────
+// The secret tokens are checked against, and the one it replaced while its
+// overlap window lasts, so tokens the Go API signed just before a rotation
+// keep working until they'd have expired anyway. `generation` changes with
+// every change to either, for caches keyed on "verified with these keys".
+struct JwtKeySet {
+    std::string secret;  // empty = JWT validation disabled (dev mode)
+    HmacKey key;
+    std::string previous_secret;
+    HmacKey previous_key;
+    int64_t previous_until = 0;  // unix seconds; previous_key is accepted before this
+    uint64_t generation = 0;
+
+    bool enabled() const { return !secret.empty(); }
+
+    const HmacKey* previous(int64_t now) const {
+        return previous_key.valid() && now < previous_until ? &previous_key : nullptr;
+    }
+
+    std::optional<JwtPayload> validate(std::string_view token) const {
+        return validate_jwt(token, key, previous(static_cast<int64_t>(std::time(nullptr))));
+    }
+};
+
+// The current JwtKeySet, shared by every loop and the auth pool. Readers
+// take a snapshot with get() and keep using it for the whole verification;
+// a rotation builds a new set and swaps it in.
+class JwtKeyRing {
+public:
+    JwtKeyRing() : keys_(std::make_shared<const JwtKeySet>()) {}
+
+    std::shared_ptr<const JwtKeySet> get() const {
+        std::lock_guard lock(mutex_);
+        return keys_;
+    }
+
+    // Makes `secret` current; the old one stays accepted for overlap_seconds.
+    // False if `secret` already is current.
+    bool rotate(const std::string& secret, int overlap_seconds) {
+        auto now = static_cast<int64_t>(std::time(nullptr));
+        auto old = get();
+        if (secret == old->secret) return false;
+
+        auto next = std::make_shared<JwtKeySet>();
+        next->secret = secret;
+        next->key = HmacKey(secret);
+        if (old->enabled() && overlap_seconds > 0) {
+            next->previous_secret = old->secret;
+            next->previous_key = HmacKey(old->secret);
+            next->previous_until = now + overlap_seconds;
+        }
+        next->generation = old->generation + 1;
+
+        std::lock_guard lock(mutex_);
+        keys_ = std::move(next);
+        return true;
+    }
+
+    // Forgets the previous secret once its overlap has ended; true if it did
+    bool expire_previous(int64_t now) {
+        auto old = get();
+        if (old->previous_secret.empty() || now < old->previous_until) return false;
+
+        auto next = std::make_shared<JwtKeySet>();
+        next->secret = old->secret;
+        next->key = HmacKey(old->secret);
+        next->generation = old->generation + 1;
+
+        std::lock_guard lock(mutex_);
+        keys_ = std::move(next);
+        return true;
+    }
+
+private:
+    // Only one thread (the loop watching Redis) rotates, so building the
+    // next set outside the lock can't lose an update
+    mutable std::mutex mutex_;
+    std::shared_ptr<const JwtKeySet> keys_;
+};
+
+} // namespace auth
@@ -0,0 +1,268 @@
+#include "server/listen_handoff.h"
+#include "utils/logger.h"
+
+#include <cerrno>
+#include <cstring>
+#include <string_view>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace server::handoff {
+
+// Most fds one handoff carries: one listen socket per event loop
+static constexpr size_t MAX_FDS = 64;
+static constexpr int REQUEST_TIMEOUT_MS = 2000;
+
+static constexpr std::string_view MSG_TAKEOVER = "TAKEOVER";
+static constexpr std::string_view MSG_FDS = "FDS";
+static constexpr std::string_view MSG_READY = "READY";
+
+static bool make_address(const std::string& path, sockaddr_un& addr) {
+    if (path.size() >= sizeof(addr.sun_path)) {
+        logger::error("HANDOFF_SOCKET path too long: " + path);
+        return false;
+    }
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+// Waits up to `timeout_ms` for `fd` to be readable
+static bool wait_readable(int fd, int timeout_ms) {
+    pollfd p{fd, POLLIN, 0};
+    int n;
+    do {
+        n = ::poll(&p, 1, timeout_ms);
+    } while (n < 0 && errno == EINTR);
+    return n > 0;
+}
+
+static bool send_message(int conn, std::string_view msg, const std::vector<int>& fds = {}) {
+    iovec iov{const_cast<char*>(msg.data()), msg.size()};
+    msghdr hdr{};
+    hdr.msg_iov = &iov;
+    hdr.msg_iovlen = 1;
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * MAX_FDS)];
+    if (!fds.empty()) {
+        size_t bytes = sizeof(int) * fds.size();
+        hdr.msg_control = control;
+        hdr.msg_controllen = CMSG_SPACE(bytes);
+        cmsghdr* cm = CMSG_FIRSTHDR(&hdr);
+        cm->cmsg_level = SOL_SOCKET;
+        cm->cmsg_type = SCM_RIGHTS;
+        cm->cmsg_len = CMSG_LEN(bytes);
+        std::memcpy(CMSG_DATA(cm), fds.data(), bytes);
+    }
+    return ::sendmsg(conn, &hdr, MSG_NOSIGNAL) == static_cast<ssize_t>(msg.size());
+}
+
+// Reads one message (and any fds it carries); "" on timeout or error
+static std::string receive_message(int conn, int timeout_ms, std::vector<int>* fds = nullptr) {
+    if (!wait_readable(conn, timeout_ms)) return {};
+
+    char buf[64];
+    iovec iov{buf, sizeof(buf)};
+    msghdr hdr{};
+    hdr.msg_iov = &iov;
+    hdr.msg_iovlen = 1;
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * MAX_FDS)];
+    hdr.msg_control = control;
+    hdr.msg_controllen = sizeof(control);
+
+    ssize_t n = ::recvmsg(conn, &hdr, MSG_CMSG_CLOEXEC);
+    if (n <= 0) return {};
+
+    for (cmsghdr* cm = CMSG_FIRSTHDR(&hdr); cm; cm = CMSG_NXTHDR(&hdr, cm)) {
+        if (cm->cmsg_level != SOL_SOCKET || cm->cmsg_type != SCM_RIGHTS) continue;
+        size_t count = (cm->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        const auto* data = reinterpret_cast<const int*>(CMSG_DATA(cm));
+        for (size_t i = 0; i < count; ++i) {
+            if (fds) fds->push_back(data[i]);
+            else ::close(data[i]);
+        }
+    }
+    return std::string(buf, static_cast<size_t>(n));
+}
+
+// ── New process ─────────────────────────────────────
+
+Takeover request(const std::string& path) {
+    Takeover t;
+    sockaddr_un addr;
+    if (!make_address(path, addr)) return t;
+
+    int conn = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (conn < 0) return t;
+    if (::connect(conn, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        // Nobody there: first start, or the previous process is gone
+        ::close(conn);
+        return t;
+    }
+
+    std::vector<int> fds;
+    if (!send_message(conn, MSG_TAKEOVER)
+        || receive_message(conn, REQUEST_TIMEOUT_MS, &fds) != MSG_FDS || fds.empty()) {
+        for (int fd : fds) ::close(fd);
+        logger::warn("previous process at " + path + " did not hand over its listen sockets");
+        ::close(conn);
+        return t;
+    }
+
+    t.conn = conn;
+    t.fds = std::move(fds);
+    return t;
+}
+
+void confirm(Takeover& takeover) {
+    if (takeover.conn < 0) return;
+    send_message(takeover.conn, MSG_READY);
+    ::close(takeover.conn);
+    takeover.conn = -1;
+}
+
+// ── Old process ─────────────────────────────────────
+
+HandoffServer::HandoffServer(std::string path, ListenFds listen_fds, HandedOff on_handed_off)
+    : path_(std::move(path)), listen_fds_(std::move(listen_fds)), on_handed_off_(std::move(on_handed_off)) {}
+
+HandoffServer::~HandoffServer() {
+    stop();
+}
+
+bool HandoffServer::start() {
+    sockaddr_un addr;
+    if (!make_address(path_, addr)) return false;
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return false;
+    ::unlink(path_.c_str());
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(fd, 4) < 0) {
+        logger::error("handoff: can't listen on " + path_ + ": " + std::strerror(errno));
+        ::close(fd);
+        return false;
+    }
+
+    fd_ = fd;
+    wake_fd_ = ::eventfd(0, EFD_CLOEXEC);
+    thread_ = std::thread([this] { run(); });
+    logger::info("accepting hot restart handoffs on " + path_);
+    return true;
+}
+
+void HandoffServer::stop() {
+    if (!thread_.joinable()) return;
+    uint64_t one = 1;
+    (void) ::write(wake_fd_, &one, sizeof(one));
+    thread_.join();
+    ::close(fd_);
+    ::close(wake_fd_);
+    fd_ = wake_fd_ = -1;
+}
+
+void HandoffServer::run() {
+    while (true) {
+        pollfd p[2] = {{fd_, POLLIN, 0}, {wake_fd_, POLLIN, 0}};
+        if (::poll(p, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        if (p[1].revents) return;
+        if (!(p[0].revents & POLLIN)) continue;
+
+        int conn = ::accept4(fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (conn < 0) continue;
+        bool handed_off = serve(conn);
+        ::close(conn);
+        if (handed_off) {
+            on_handed_off_();
+            return;  // nothing left to hand over
+        }
+    }
+}
+
+bool HandoffServer::serve(int conn) {
+    if (receive_message(conn, CONFIRM_TIMEOUT_MS) != MSG_TAKEOVER) return false;
+
+    auto fds = listen_fds_();
+    if (fds.empty() || fds.size() > MAX_FDS) {
+        logger::warn("handoff requested before this process is listening, refused");
+        return false;
+    }
+    if (!send_message(conn, MSG_FDS, fds)) return false;
+
+    // Until the new process accepts on them, both hold the sockets and this
+    // one keeps accepting; without a confirmation nothing changes here
+    if (receive_message(conn, CONFIRM_TIMEOUT_MS) != MSG_READY) {
+        logger::warn("new process took the listen sockets but never confirmed, keeping them");
+        return false;
+    }
+    logger::info("handed " + std::to_string(fds.size()) + " listen sockets to the new process");
+    return true;
+}
+
+// ── Accepting on inherited sockets ──────────────────
+
+ListenAcceptor::ListenAcceptor(std::vector<int> fds, OnAccept on_accept)
+    : fds_(std::move(fds)), on_accept_(std::move(on_accept)) {
+    for (int fd : fds_) ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+    wake_fd_ = ::eventfd(0, EFD_CLOEXEC);
+    thread_ = std::thread([this] { run(); });
+}
+
+ListenAcceptor::~ListenAcceptor() {
+    stop();
+}
+
+std::vector<int> ListenAcceptor::fds() {
+    std::lock_guard lock(stop_mutex_);
+    return stopped_ ? std::vector<int>{} : fds_;
+}
+
+void ListenAcceptor::stop() {
+    std::lock_guard lock(stop_mutex_);
+    if (stopped_) return;
+    stopped_ = true;
+
+    uint64_t one = 1;
+    (void) ::write(wake_fd_, &one, sizeof(one));
+    if (thread_.joinable()) thread_.join();
+    for (int fd : fds_) ::close(fd);
+    ::close(wake_fd_);
+}
+
+void ListenAcceptor::run() {
+    std::vector<pollfd> polls;
+    for (int fd : fds_) polls.push_back({fd, POLLIN, 0});
+    polls.push_back({wake_fd_, POLLIN, 0});
+
+    while (true) {
+        if (::poll(polls.data(), polls.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        if (polls.back().revents) return;
+
+        for (size_t i = 0; i + 1 < polls.size(); ++i) {
+            if (!(polls[i].revents & POLLIN)) continue;
+            // Non-blocking, so this drains the queue and stops at EAGAIN
+            while (true) {
+                int fd = ::accept4(polls[i].fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                if (fd < 0) break;
+                int one = 1;
+                ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                on_accept_(fd);
+            }
+        }
+    }
+}
+
+} // namespace server::handoff
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+namespace server {
+
+// ── Listen socket handoff (hot restart) ─────────────
+// A new gameserver process takes over the listening sockets of the one it
+// replaces through a Unix socket (HANDOFF_SOCKET), with SCM_RIGHTS. The
+// kernel sockets are never closed, so the port keeps accepting throughout
+// and connections already queued on it aren't reset. The old process stops
+// accepting once the new one confirms, and drains.
+//
+//   new → old   "TAKEOVER"
+//   old → new   "FDS" + the listen fds
+//   new → old   "READY", once it accepts on them
+//
+// uSockets can only listen on a socket it created itself, so a process
+// that took its listen sockets over accepts on them with ListenAcceptor and
+// hands each connection to an event loop (adoptSocket), and passes the same
+// sockets on at the next restart.
+namespace handoff {
+
+// Listen fds received from the previous process, and the connection on
+// which to confirm them. Empty when nobody served the path (first start)
+// or the old process wasn't ready.
+struct Takeover {
+    int conn = -1;
+    std::vector<int> fds;
+};
+
+Takeover request(const std::string& path);
+
+// Tells the old process we accept on the fds now; it stops and drains
+void confirm(Takeover& takeover);
+
+// Serves takeover requests on `path` from a thread of its own, until one
+// succeeds or stop(). `listen_fds` runs on that thread and returns the fds
+// to hand over (empty = not listening yet, refuse); `on_handed_off` runs
+// there once the new process has confirmed.
+class HandoffServer {
+public:
+    using ListenFds = std::function<std::vector<int>()>;
+    using HandedOff = std::function<void()>;
+
+    // How long the new process has to confirm before the old one keeps its sockets
+    static constexpr int CONFIRM_TIMEOUT_MS = 5000;
+
+    HandoffServer(std::string path, ListenFds listen_fds, HandedOff on_handed_off);
+    ~HandoffServer();
+
+    HandoffServer(const HandoffServer&) = delete;
+    HandoffServer& operator=(const HandoffServer&) = delete;
+
+    // Binds `path` (replacing whatever is there); false if it can't
+    bool start();
+    void stop();
+
+private:
+    void run();
+    bool serve(int conn);
+
+    std::string path_;
+    ListenFds listen_fds_;
+    HandedOff on_handed_off_;
+    int fd_ = -1;
+    int wake_fd_ = -1;  // eventfd, wakes run() for stop()
+    std::thread thread_;
+};
+
+// Accepts on listen sockets taken over from the previous process, on a
+// thread of its own, and passes each connection (non-blocking, TCP_NODELAY)
+// to `on_accept`. Owns the fds: stop() closes them.
+class ListenAcceptor {
+public:
+    using OnAccept = std::function<void(int fd)>;
+
+    ListenAcceptor(std::vector<int> fds, OnAccept on_accept);
+    ~ListenAcceptor();
+
+    ListenAcceptor(const ListenAcceptor&) = delete;
+    ListenAcceptor& operator=(const ListenAcceptor&) = delete;
+
+    // The sockets, to pass on at the next restart; empty once stopped
+    std::vector<int> fds();
+
+    // Safe to call from any thread but its own, more than once
+    void stop();
+
+private:
+    void run();
+
+    std::vector<int> fds_;
+    OnAccept on_accept_;
+    int wake_fd_ = -1;
+    std::thread thread_;
+    std::mutex stop_mutex_;
+    bool stopped_ = false;
+};
+
+} // namespace handoff
+
+} // namespace server
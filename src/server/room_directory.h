@@ -0,0 +1,77 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <shared_mutex>
+#include <mutex>
+#include <cstdint>
+
+namespace server {
+
+// ── Room → shard directory ──────────────────────────
+// A room starts on its home shard, picked by a stable hash of its code.
+// Rooms the balancer has moved elsewhere are recorded here. Every loop
+// reads this on accept, so lookups take a shared lock and moves an
+// exclusive one.
+class RoomDirectory {
+public:
+    explicit RoomDirectory(int shard_count = 1) : shard_count_(shard_count) {}
+
+    int shard_count() const { return shard_count_; }
+
+    // FNV-1a: stable across builds and platforms, unlike std::hash
+    int home_of(std::string_view room_id) const {
+        uint32_t h = 2166136261u;
+        for (unsigned char c : room_id) {
+            h ^= c;
+            h *= 16777619u;
+        }
+        return static_cast<int>(h % static_cast<uint32_t>(shard_count_));
+    }
+
+    int owner_of(const std::string& room_id) const {
+        std::shared_lock lock(mutex_);
+        auto it = moved_.find(room_id);
+        return it != moved_.end() ? it->second.shard : home_of(room_id);
+    }
+
+    // True between begin_move() and finish_move(): the new owner doesn't
+    // have the room yet and must not create a fresh one
+    bool in_transit(const std::string& room_id) const {
+        std::shared_lock lock(mutex_);
+        auto it = moved_.find(room_id);
+        return it != moved_.end() && it->second.in_transit;
+    }
+
+    void begin_move(const std::string& room_id, int to) {
+        std::unique_lock lock(mutex_);
+        moved_[room_id] = {to, true};
+    }
+
+    void finish_move(const std::string& room_id) {
+        std::unique_lock lock(mutex_);
+        auto it = moved_.find(room_id);
+        if (it == moved_.end()) return;
+        if (it->second.shard == home_of(room_id)) moved_.erase(it);  // back home
+        else it->second.in_transit = false;
+    }
+
+    // Room was destroyed; a new room with this code starts at home again
+    void forget(const std::string& room_id) {
+        std::unique_lock lock(mutex_);
+        moved_.erase(room_id);
+    }
+
+private:
+    struct Entry {
+        int shard;
+        bool in_transit;
+    };
+
+    int shard_count_;
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::string, Entry> moved_;
+};
+
+} // namespace server
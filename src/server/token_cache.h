@@ -0,0 +1,125 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "server/jwt_keys.h"
+
+namespace auth {
+
+// ── Verified-token cache ────────────────────────────
+// Players on flaky networks reconnect with the same token over and over.
+// Tokens that passed validate_jwt() are kept here, keyed by a hash of the
+// token, until their exp; a hit skips the base64 decode, HMAC and JSON
+// parse. Entries keep the token itself, so a hash collision is a miss,
+// never someone else's payload. Tokens without exp aren't cached, and a
+// new JwtKeySet generation (a rotation, or the previous secret's overlap
+// ending) empties the cache. Thread-safe: every loop and the auth pool
+// share one.
+class TokenCache {
+public:
+    explicit TokenCache(size_t capacity) : capacity_(capacity) {}
+
+    size_t capacity() const { return capacity_; }
+
+    // Cached payload for a token verified with key set `generation`, if
+    // still unexpired
+    std::optional<JwtPayload> find(const std::string& token, uint64_t generation) {
+        if (capacity_ == 0) return std::nullopt;
+        auto now = static_cast<int64_t>(std::time(nullptr));
+
+        std::lock_guard lock(mutex_);
+        auto it = current(generation) ? entries_.find(hash(token)) : entries_.end();
+        if (it == entries_.end() || it->second.token != token) {
+            misses_.fetch_add(1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+        if (now > it->second.payload.exp) {
+            entries_.erase(it);
+            misses_.fetch_add(1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        return it->second.payload;
+    }
+
+    void insert(const std::string& token, uint64_t generation, const JwtPayload& payload) {
+        if (capacity_ == 0 || payload.exp <= 0) return;
+        auto now = static_cast<int64_t>(std::time(nullptr));
+
+        std::lock_guard lock(mutex_);
+        if (!current(generation)) return;
+        if (entries_.size() >= capacity_) evict(now);
+        entries_[hash(token)] = {token, payload};
+    }
+
+    // validate_jwt() behind the cache
+    std::optional<JwtPayload> verify(const std::string& token, const JwtKeySet& keys) {
+        if (auto cached = find(token, keys.generation)) return cached;
+        auto payload = keys.validate(token);
+        if (payload) insert(token, keys.generation, *payload);
+        return payload;
+    }
+
+    uint64_t hits() const { return hits_.load(std::memory_order_relaxed); }
+    uint64_t misses() const { return misses_.load(std::memory_order_relaxed); }
+
+    size_t size() const {
+        std::lock_guard lock(mutex_);
+        return entries_.size();
+    }
+
+private:
+    struct Entry {
+        std::string token;
+        JwtPayload payload;
+    };
+
+    // FNV-1a, 64-bit
+    static uint64_t hash(std::string_view token) {
+        uint64_t h = 14695981039346656037ull;
+        for (unsigned char c : token) {
+            h ^= c;
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+
+    // Moves the cache to a newer generation, emptying it. False for an older
+    // one: a verification that started before a rotation isn't cached.
+    bool current(uint64_t generation) {
+        if (generation < generation_) return false;
+        if (generation > generation_) {
+            entries_.clear();
+            generation_ = generation;
+        }
+        return true;
+    }
+
+    // Drop expired entries, then arbitrary ones down to 7/8 full, so a full
+    // cache of live tokens isn't swept on every insert
+    void evict(int64_t now) {
+        for (auto it = entries_.begin(); it != entries_.end();) {
+            if (now > it->second.payload.exp) it = entries_.erase(it);
+            else ++it;
+        }
+        while (!entries_.empty() && entries_.size() > capacity_ - capacity_ / 8 - 1) {
+            entries_.erase(entries_.begin());
+        }
+    }
+
+    size_t capacity_;
+    mutable std::mutex mutex_;
+    std::unordered_map<uint64_t, Entry> entries_;
+    uint64_t generation_ = 0;  // the key set every entry was verified with
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+};
+
+} // namespace auth
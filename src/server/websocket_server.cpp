@@ -14,13 +14,30 @@ extern "C" {
     void us_timer_set(struct us_timer_t *timer, void (*cb)(struct us_timer_t *), int ms, int repeat_ms);
     void us_timer_close(struct us_timer_t *timer);
     void *us_timer_ext(struct us_timer_t *timer);
+
+    struct us_poll_t;
+    int us_poll_fd(struct us_poll_t *p);
+
+    struct us_listen_socket_t;
+    void us_listen_socket_close(int ssl, struct us_listen_socket_t *ls);
 }
 
 #include <string>
+#include <array>
+#include <optional>
 #include <sstream>
 #include <random>
 #include <algorithm>
 #include <cstring>
+#include <thread>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <unistd.h>
 
 namespace server {
 
@@ -38,17 +55,90 @@ static std::string generate_id(int len = 8) {
     return id;
 }
 
+// game_state topic a connection subscribes to; delta clients get per-player frames
+static std::optional<game::Room::Topic> game_state_topic(network::WireFormat format) {
+    switch (format) {
+        case network::WireFormat::JSON:         return game::Room::Topic::GAME_STATE_JSON;
+        case network::WireFormat::BINARY:       return game::Room::Topic::GAME_STATE_BINARY;
+        case network::WireFormat::BINARY_DELTA: return std::nullopt;
+    }
+    return std::nullopt;
+}
+
+// Shard whose loop runs on this thread. uWS preOpen handlers are plain
+// function pointers, so they find their shard through this.
+struct ShardThread {
+    WebSocketServer* server = nullptr;
+    Shard* shard = nullptr;
+};
+static thread_local ShardThread current_shard;
+
+// What an upgrade needs after JWT verification, copied out of the request
+struct PendingUpgrade {
+    std::string room_id;
+    std::string player_id;
+    std::string player_name = "Player";
+    network::WireFormat wire_format = network::WireFormat::JSON;
+    std::string protocol;  // Sec-WebSocket-Protocol to echo back
+    std::string key;
+    std::string extensions;
+    std::string path;  // for a redirect to another node; never the query, which carries the token
+};
+
+// server:capacity (node → score) and server:capacity:seen (node → last
+// publish): records this node, then drops nodes that stopped publishing.
+// Both sets expire a status TTL after the last publish by any node, so
+// they don't outlive a fleet that stopped altogether.
+static constexpr const char* CAPACITY_SCRIPT =
+    "redis.call('ZADD', KEYS[1], ARGV[2], ARGV[1]) "
+    "redis.call('ZADD', KEYS[2], ARGV[3], ARGV[1]) "
+    "local gone = redis.call('ZRANGEBYSCORE', KEYS[2], '-inf', '(' .. ARGV[4]) "
+    "for _, node in ipairs(gone) do "
+    "  redis.call('ZREM', KEYS[1], node) "
+    "  redis.call('ZREM', KEYS[2], node) "
+    "end "
+    "redis.call('EXPIRE', KEYS[1], ARGV[5]) "
+    "redis.call('EXPIRE', KEYS[2], ARGV[5]) "
+    "return #gone";
+
+// Milliseconds on the steady clock, for shard liveness
+static int64_t steady_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static int shard_count_for(const config::ServerConfig& cfg) {
+    return cfg.worker_threads > 0
+        ? cfg.worker_threads
+        : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
 WebSocketServer::WebSocketServer(const config::ServerConfig& cfg)
-    : cfg_(cfg) {
+    : cfg_(cfg), directory_(shard_count_for(cfg)), token_cache_(static_cast<size_t>(std::max(0, cfg.token_cache_size))),
+      room_leases_(cfg.node_url, std::max(1, cfg.room_lease_seconds)) {
     tick_dt_ = 1.0f / static_cast<float>(cfg.tick_rate);
 
+    for (int i = 0; i < directory_.shard_count(); ++i) {
+        auto shard = std::make_unique<Shard>();
+        shard->index = i;
+        if (cfg.sim_workers > 0) {
+            shard->sim_pool = std::make_unique<utils::WorkPool>(cfg.sim_workers);
+        }
+        shards_.push_back(std::move(shard));
+    }
+    if (cfg.auth_workers > 0) {
+        auth_pool_ = std::make_unique<utils::TaskPool>(cfg.auth_workers);
+    }
+
     // Connect to Redis and fetch JWT secret
     bool redis_connected = false;
 
     // First try with password if provided
     if (!cfg.redis_password.empty()) {
         redis_connected = redis_.connect(cfg.redis_addr, cfg.redis_port, cfg.redis_password);
-        if (!redis_connected) {
+        if (redis_connected) {
+            redis_password_ = cfg.redis_password;
+        } else {
             logger::warn("Redis auth failed, retrying without password...");
             redis_connected = redis_.connect(cfg.redis_addr, cfg.redis_port, "");
         }
@@ -59,14 +149,29 @@ WebSocketServer::WebSocketServer(const config::ServerConfig& cfg)
     if (redis_connected) {
         auto secret = redis_.get("jwt:secret");
         if (secret) {
-            jwt_secret_ = *secret;
-            logger::info("JWT secret loaded from Redis (" + std::to_string(jwt_secret_.size()) + " bytes)");
+            jwt_keys_.rotate(*secret, 0);
+            logger::info("JWT secret loaded from Redis (" + std::to_string(secret->size()) + " bytes)");
         } else {
             logger::warn("jwt:secret not found in Redis — JWT validation disabled");
         }
     } else {
         logger::warn("Redis not available — JWT validation disabled, running in dev mode");
     }
+
+    node_id_ = cfg.node_url;
+    if (node_id_.empty()) {
+        char host[256] = {};
+        ::gethostname(host, sizeof(host) - 1);
+        node_id_ = std::string(host) + ":" + std::to_string(cfg.port);
+    }
+
+    if (room_leases_.enabled()) {
+        if (redis_connected) {
+            logger::info("room directory in Redis, this node is " + room_leases_.node_url());
+        } else {
+            logger::warn("NODE_URL set but Redis not available — rooms are local to this node");
+        }
+    }
 }
 
 std::unordered_map<std::string, std::string> WebSocketServer::parse_query(std::string_view url) {
@@ -97,84 +202,1093 @@ std::unordered_map<std::string, std::string> WebSocketServer::parse_query(std::s
     return params;
 }
 
-game::Room* WebSocketServer::get_or_create_room(const std::string& room_id) {
-    auto it = rooms_.find(room_id);
-    if (it != rooms_.end()) {
+std::optional<std::string_view> WebSocketServer::room_from_request_line(std::string_view head) {
+    // "GET /ws/<room>[?query] HTTP/1.1" — same room code the upgrade handler
+    // takes from getUrl()
+    constexpr std::string_view prefix = "GET /ws/";
+    if (head.substr(0, prefix.size()) != prefix) return std::nullopt;
+    head.remove_prefix(prefix.size());
+
+    auto end = head.find_first_of("? \r\n");
+    if (end == std::string_view::npos || end == 0) return std::nullopt;
+    return head.substr(0, end);
+}
+
+game::Room* WebSocketServer::get_or_create_room(Shard& shard, const std::string& room_id) {
+    auto it = shard.rooms.find(room_id);
+    if (it != shard.rooms.end()) {
         return it->second.get();
     }
 
-    if (static_cast<int>(rooms_.size()) >= cfg_.max_rooms) {
+    if (draining()) {
+        logger::debug("draining, not creating room " + room_id);
+        return nullptr;
+    }
+
+    // Reserve a slot in the node-wide room budget
+    if (room_count_.fetch_add(1) >= cfg_.max_rooms) {
+        room_count_.fetch_sub(1);
         logger::warn("max rooms reached (" + std::to_string(cfg_.max_rooms) + "), rejecting");
         return nullptr;
     }
 
-    auto room = std::make_unique<game::Room>(room_id, cfg_.max_players_per_room);
+    auto room = std::make_unique<game::Room>(room_id, cfg_.max_players_per_room, &shard.sim_world);
     auto* ptr = room.get();
-    rooms_.emplace(room_id, std::move(room));
-    logger::info("created room " + room_id);
+    shard.rooms.emplace(room_id, std::move(room));
+    setup_room_broadcast(shard, ptr);
+    logger::info("created room " + room_id + " on shard " + std::to_string(shard.index));
     return ptr;
 }
 
-game::Room* WebSocketServer::get_room(const std::string& room_id) {
-    auto it = rooms_.find(room_id);
-    if (it == rooms_.end()) return nullptr;
+game::Room* WebSocketServer::get_room(Shard& shard, const std::string& room_id) {
+    auto it = shard.rooms.find(room_id);
+    if (it == shard.rooms.end()) return nullptr;
     return it->second.get();
 }
 
-void WebSocketServer::cleanup_empty_rooms() {
-    for (auto it = rooms_.begin(); it != rooms_.end();) {
+game::Room* WebSocketServer::restore_room(Shard& shard, const std::string& room_id, std::string_view checkpoint) {
+    if (room_count_.fetch_add(1) >= cfg_.max_rooms) {
+        room_count_.fetch_sub(1);
+        logger::warn("max rooms reached (" + std::to_string(cfg_.max_rooms) + "), not restoring room " + room_id);
+        return nullptr;
+    }
+
+    auto room = game::Room::restore(room_id, checkpoint, &shard.sim_world);
+    if (!room) {
+        room_count_.fetch_sub(1);
+        logger::warn("checkpoint of room " + room_id + " is unusable, starting it fresh");
+        return nullptr;
+    }
+
+    auto* ptr = room.get();
+    shard.rooms.emplace(room_id, std::move(room));
+    setup_room_broadcast(shard, ptr);
+    shard.checkpoints_restored.fetch_add(1, std::memory_order_relaxed);
+    logger::info("restored room " + room_id + " from its checkpoint at tick "
+                 + std::to_string(ptr->current_tick()) + " on shard " + std::to_string(shard.index));
+    return ptr;
+}
+
+void WebSocketServer::cleanup_empty_rooms(Shard& shard) {
+    for (auto it = shard.rooms.begin(); it != shard.rooms.end();) {
         if (it->second->should_cleanup()) {
             logger::info("cleaning up room " + it->first);
-            it = rooms_.erase(it);
+            directory_.forget(it->first);
+            if (room_leases_.enabled() && shard.redis) room_leases_.release(*shard.redis, it->first);
+            if (checkpoints_enabled() && shard.redis) shard.redis->command({"DEL", checkpoint_key(it->first)});
+            it = shard.rooms.erase(it);
+            room_count_.fetch_sub(1);
         } else {
             ++it;
         }
     }
 }
 
-void WebSocketServer::setup_room_broadcast(game::Room* room) {
+std::string WebSocketServer::room_topic(const std::string& room_id, game::Room::Topic topic) {
+    switch (topic) {
+        case game::Room::Topic::ALL:               return "room/" + room_id;
+        case game::Room::Topic::GAME_STATE_JSON:   return "room/" + room_id + "/gs.json";
+        case game::Room::Topic::GAME_STATE_BINARY: return "room/" + room_id + "/gs.bin";
+    }
+    return "room/" + room_id;
+}
+
+void WebSocketServer::setup_room_broadcast(Shard& shard, game::Room* room) {
+    // Room-wide messages: framed once by uWS and fanned out to subscribers.
+    // Slow subscribers are held to .maxBackpressure by the library.
+    std::array<std::string, 3> topics = {
+        room_topic(room->id(), game::Room::Topic::ALL),
+        room_topic(room->id(), game::Room::Topic::GAME_STATE_JSON),
+        room_topic(room->id(), game::Room::Topic::GAME_STATE_BINARY)
+    };
+    room->set_publish_fn(
+        [&shard, topics = std::move(topics)](game::Room::Topic topic, const std::string& message, bool binary) {
+            if (!shard.app) return;
+            static_cast<uWS::App*>(shard.app)->publish(topics[static_cast<size_t>(topic)], message,
+                                                  binary ? uWS::OpCode::BINARY : uWS::OpCode::TEXT);
+        }
+    );
+
+    // Per-player sends (send_to, broadcast_except, delta snapshots)
     room->set_broadcast_fn(
-        [this](const std::string& pid, const std::string& message) {
-            auto it = player_sockets_.find(pid);
-            if (it == player_sockets_.end()) return;
+        [&shard](game::PlayerHandle player, const std::string& message, bool binary) {
+            void* sock = shard.socket_of(player);
+            if (!sock) return;
 
-            auto* ws = static_cast<uWS::WebSocket<false, true, PerSocketData>*>(it->second);
+            auto* ws = static_cast<uWS::WebSocket<false, true, PerSocketData>*>(sock);
 
             // Check backpressure before sending
             auto bp = ws->getBufferedAmount();
             if (bp > 128 * 1024) {
-                logger::warn("high backpressure for player " + pid + ": " + std::to_string(bp) + " bytes, dropping message");
+                logger::warn("high backpressure for player " + ws->getUserData()->player_id + ": " + std::to_string(bp) + " bytes, dropping message");
                 return;  // Drop message instead of overwhelming the socket
             }
 
-            auto status = ws->send(message, uWS::OpCode::TEXT);
+            auto status = ws->send(message, binary ? uWS::OpCode::BINARY : uWS::OpCode::TEXT);
             if (status == uWS::WebSocket<false, true, PerSocketData>::DROPPED) {
-                logger::warn("message dropped for player " + pid + " (socket closing)");
+                logger::warn("message dropped for player " + ws->getUserData()->player_id + " (socket closing)");
             }
         }
     );
 }
 
-void WebSocketServer::tick() {
-    tick_count_++;
+void WebSocketServer::tick(Shard& shard) {
+    auto started = std::chrono::steady_clock::now();
+    shard.tick_count++;
+
+    // Timer lateness: anything the loop did between ticks that ran long
+    if (shard.tick_count > 1) {
+        auto interval_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            started - shard.last_tick_at).count();
+        auto lag_us = interval_us - static_cast<int64_t>(tick_dt_ * 1e6f);
+        uint64_t lag = lag_us > 0 ? static_cast<uint64_t>(lag_us) : 0;
+        shard.tick_lag.record(lag);
+        uint64_t prev = shard.stat_tick_lag_max_us.load(std::memory_order_relaxed);
+        while (lag > prev && !shard.stat_tick_lag_max_us.compare_exchange_weak(prev, lag, std::memory_order_relaxed)) {}
+    }
+    shard.last_tick_at = started;
+
+    // Every playing room advances its tick, then one physics pass steps the
+    // lanes of all of them, then each room encodes its snapshot (together
+    // the simulate phase, spread over sim_pool if there is one), then each
+    // room sends its frames from the loop
+    shard.stepped_rooms.clear();
+    int players = 0;
+    int playing = 0;
+    for (auto& [id, room] : shard.rooms) {
+        players += room->player_count();
+        if (room->state() != game::RoomState::PLAYING) continue;
+        playing++;
+        if (room->begin_update()) {
+            shard.stepped_rooms.push_back(room.get());
+        }
+    }
 
-    for (auto& [id, room] : rooms_) {
-        if (room->state() == game::RoomState::PLAYING) {
-            room->update(tick_dt_);
+    if (!shard.stepped_rooms.empty()) {
+        auto& rooms = shard.stepped_rooms;
+        if (shard.sim_pool) {
+            auto& lanes = shard.sim_world.lanes;
+            size_t chunks = (lanes.size() + SIM_CHUNK_LANES - 1) / SIM_CHUNK_LANES;
+            shard.sim_pool->parallel_for(chunks, [&](size_t c) {
+                size_t begin = c * SIM_CHUNK_LANES;
+                game::physics::step(lanes, begin, std::min(lanes.size(), begin + SIM_CHUNK_LANES), tick_dt_);
+            });
+            shard.sim_pool->parallel_for(rooms.size(), [&](size_t i) {
+                rooms[i]->encode_game_state();
+            });
+        } else {
+            game::physics::step(shard.sim_world.lanes, tick_dt_);
+            for (auto* room : rooms) room->encode_game_state();
+        }
+        for (auto* room : rooms) room->send_game_state();
+    }
+
+    // Rooms whose grace period ran out without anyone reconnecting
+    if (shard.tick_count % cfg_.tick_rate == 0) {
+        cleanup_empty_rooms(shard);
+    }
+
+    int renew_ticks = cfg_.tick_rate * std::max(1, cfg_.room_lease_seconds / LEASE_RENEWALS_PER_TTL);
+    if (room_leases_.enabled() && shard.redis && shard.tick_count % renew_ticks == 0) {
+        renew_room_leases(shard);
+    }
+
+    if (checkpoints_enabled() && shard.redis) {
+        write_checkpoints(shard);
+    }
+
+    shard.stat_rooms.store(static_cast<int>(shard.rooms.size()), std::memory_order_relaxed);
+    shard.stat_rooms_playing.store(playing, std::memory_order_relaxed);
+    shard.stat_players.store(players, std::memory_order_relaxed);
+    shard.stat_tick.store(shard.tick_count, std::memory_order_relaxed);
+    shard.stat_last_tick_ms.store(steady_ms(), std::memory_order_relaxed);
+
+    // Tick cost, smoothed over ~16 ticks, for the balancer
+    double tick_us = std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - started).count();
+    shard.tick_us_avg += (tick_us - shard.tick_us_avg) / 16.0;
+    shard.stat_tick_us.store(static_cast<int>(shard.tick_us_avg), std::memory_order_relaxed);
+
+    if (shards_.size() > 1 && cfg_.rebalance_ratio > 0 && !draining()
+        && shard.tick_count % REBALANCE_EVERY_TICKS == 0) {
+        maybe_rebalance(shard);
+    }
+
+    if (draining()) drain(shard);
+}
+
+void WebSocketServer::maybe_rebalance(Shard& shard) {
+    int64_t now = steady_ms();
+    if (now < shard.rebalance_after_ms) return;
+
+    // Only the slowest shard gives work away
+    int hot_us = shard.stat_tick_us.load(std::memory_order_relaxed);
+    if (hot_us < REBALANCE_MIN_LOAD * tick_dt_ * 1e6) return;
+
+    Shard* coolest = nullptr;
+    int cold_us = hot_us;
+    for (auto& other : shards_) {
+        if (other.get() == &shard) continue;
+        int us = other->stat_tick_us.load(std::memory_order_relaxed);
+        if (us > hot_us) return;
+        if (us < cold_us) {
+            cold_us = us;
+            coolest = other.get();
+        }
+    }
+    if (!coolest || hot_us < cold_us * cfg_.rebalance_ratio) return;
+
+    // A room's share of the tick is taken as its share of the shard's
+    // players. Move the biggest room that doesn't overshoot the midpoint,
+    // so the two shards don't just trade places.
+    int players = shard.stat_players.load(std::memory_order_relaxed);
+    if (players == 0) return;
+    double budget_us = (hot_us - cold_us) / 2.0;
+    const game::Room* best = nullptr;
+    double best_us = 0;
+    for (const auto& [id, room] : shard.rooms) {
+        if (room->state() != game::RoomState::PLAYING) continue;
+        double cost_us = static_cast<double>(hot_us) * room->player_count() / players;
+        if (cost_us <= budget_us && cost_us > best_us) {
+            best = room.get();
+            best_us = cost_us;
         }
     }
+    if (!best) return;
+
+    logger::info("rebalance: shard " + std::to_string(shard.index) + " at "
+                 + std::to_string(hot_us) + "us/tick, shard " + std::to_string(coolest->index)
+                 + " at " + std::to_string(cold_us) + "us/tick — moving room " + best->id()
+                 + " (~" + std::to_string(static_cast<int>(best_us)) + "us)");
+    migrate_room(shard, *coolest, best->id());
+    shard.rebalance_after_ms = now + REBALANCE_COOLDOWN_MS;
+}
+
+void WebSocketServer::migrate_room(Shard& from, Shard& to, const std::string& room_id) {
+    auto it = from.rooms.find(room_id);
+    if (it == from.rooms.end()) return;
+    std::unique_ptr<game::Room> room = std::move(it->second);
+    from.rooms.erase(it);
+
+    // From here new connections for the room go to `to`, which holds them
+    // off until the room arrives
+    directory_.begin_move(room_id, to.index);
+    auto started = std::chrono::steady_clock::now();
+
+    // Detach from this loop. A WebSocket can't change loops, so players are
+    // disconnected and reconnect into their held seats on the new one.
+    room->set_publish_fn(nullptr);
+    room->set_broadcast_fn(nullptr);
+    auto players = room->players();
+    room->detach_all();
+    room->move_to_world(nullptr);
+    close_players(from, players, CLOSE_ROOM_MOVED, "room_moved");  // close handler no longer finds the room
+
+    // Raw pointer: the deferred callback owns the room from here
+    game::Room* moving = room.release();
+    static_cast<uWS::Loop*>(to.loop)->defer([this, &to, moving, started]() {
+        std::unique_ptr<game::Room> room(moving);
+        std::string id = room->id();
+
+        room->move_to_world(&to.sim_world);
+        setup_room_broadcast(to, room.get());
+        to.rooms.emplace(id, std::move(room));
+        directory_.finish_move(id);
+
+        to.migration_latency.record_since(started);
+        logger::info("room " + id + " now on shard " + std::to_string(to.index));
+    });
+}
+
+void WebSocketServer::close_players(Shard& shard, const std::vector<game::PlayerHandle>& players,
+                                    int code, std::string_view reason) {
+    for (game::PlayerHandle player : players) {
+        void* sock = shard.socket_of(player);
+        if (!sock) continue;
+        auto* ws = static_cast<uWS::WebSocket<false, true, PerSocketData>*>(sock);
+        ws->end(code, reason);
+    }
+}
+
+// ── Drain ───────────────────────────────────────────
+
+void WebSocketServer::drain(Shard& shard) {
+    int64_t now = steady_ms();
+    if (!shard.draining) {
+        shard.draining = true;
+        shard.drain_deadline_ms = now + 1000LL * std::max(0, cfg_.drain_timeout_seconds);
+
+        // Lobbies have no match to finish; their players can regroup on
+        // another node
+        std::vector<game::PlayerHandle> lobby_players;
+        for (const auto& [id, room] : shard.rooms) {
+            if (room->state() != game::RoomState::WAITING) continue;
+            auto players = room->players();
+            lobby_players.insert(lobby_players.end(), players.begin(), players.end());
+        }
+        close_players(shard, lobby_players, CLOSE_SERVER_DRAINING, "server_draining");
+
+        logger::info("shard " + std::to_string(shard.index) + " draining: "
+                     + std::to_string(shard.rooms.size()) + " rooms, deadline in "
+                     + std::to_string(cfg_.drain_timeout_seconds) + "s");
+    }
+
+    if (shard.closing) {
+        if (now >= shard.close_by_ms) close_shard(shard);
+        return;
+    }
+
+    // A newer process took over the listen sockets: hand the rooms over
+    // now, so each exists in one process only
+    bool cut_short = drain_requests_.load(std::memory_order_relaxed) > 1
+                     || handed_off_.load(std::memory_order_relaxed);
+    if (!shard.rooms.empty() && now < shard.drain_deadline_ms && !cut_short) return;
+
+    shard.closing = true;
+    shard.close_by_ms = now + DRAIN_FLUSH_MS;
+    if (!shard.rooms.empty()) {
+        logger::warn("shard " + std::to_string(shard.index) + " stopping with "
+                     + std::to_string(shard.rooms.size()) + " rooms still open");
+    }
+    if (!shard.redis || !shard.redis->connected()) {
+        close_shard(shard);
+        return;
+    }
+
+    // Hand what is still playing over to the fleet: a fresh checkpoint and
+    // no lease, so the players' reconnects restore it on another node
+    std::vector<std::pair<storage::AsyncRedisClient::Command, storage::AsyncRedisClient::Callback>> batch;
+    std::string ttl = std::to_string(std::max(1, cfg_.checkpoint_ttl_seconds));
+    for (const auto& [id, room] : shard.rooms) {
+        shard.checkpoint_buf.clear();
+        if (checkpoints_enabled() && room->write_checkpoint(shard.checkpoint_buf)) {
+            batch.push_back({{"SET", checkpoint_key(id), shard.checkpoint_buf, "EX", ttl}, {}});
+        }
+    }
+    shard.checkpoint_queue.clear();
+    shard.redis->pipeline(std::move(batch));
+    if (room_leases_.enabled()) {
+        for (const auto& [id, room] : shard.rooms) room_leases_.release(*shard.redis, id);
+    }
+
+    // Take this node off the matchmaker's list rather than leave it there
+    // at 0 until pruned; after a hot restart the member is the successor's
+    if (shard.index == 0 && cfg_.status_interval_ms > 0 && !handed_off_.load(std::memory_order_relaxed)) {
+        shard.redis->pipeline({
+            {{"ZREM", "server:capacity", node_id_}, {}},
+            {{"ZREM", "server:capacity:seen", node_id_}, {}}
+        });
+    }
+
+    // Replies come in order: once this one is back, so is everything above
+    shard.redis->command({"PING"}, [this, &shard](const storage::RedisReply&) {
+        auto* loop = static_cast<uWS::Loop*>(shard.loop);
+        loop->defer([this, &shard] { close_shard(shard); });
+    });
+}
+
+void WebSocketServer::close_shard(Shard& shard) {
+    if (shard.closed) return;
+    shard.closed = true;
+
+    std::vector<game::PlayerHandle> players;
+    for (size_t player = 0; player < shard.player_sockets.size(); ++player) {
+        if (shard.player_sockets[player]) players.push_back(static_cast<game::PlayerHandle>(player));
+    }
+    close_players(shard, players, CLOSE_SERVER_DRAINING, "server_draining");
+
+    // Nothing left to keep the loop running, so run_shard() returns
+    shard.listen_fd.store(-1);
+    if (shard.listen_socket) {
+        us_listen_socket_close(0, static_cast<us_listen_socket_t*>(shard.listen_socket));
+        shard.listen_socket = nullptr;
+    }
+    if (inherited_listener_) inherited_listener_->stop();
+    for (void* timer : shard.timers) us_timer_close(static_cast<us_timer_t*>(timer));
+    shard.timers.clear();
+    if (shard.redis_sub) shard.redis_sub->stop();
+    if (shard.redis) shard.redis->stop();
+
+    logger::info("shard " + std::to_string(shard.index) + " stopped");
+}
+
+void WebSocketServer::renew_room_leases(Shard& shard) {
+    std::vector<std::string> ids;
+    ids.reserve(shard.rooms.size());
+    for (const auto& [id, room] : shard.rooms) ids.push_back(id);
+
+    // Both nodes now have players in the room; nothing to do but say so.
+    // New upgrades go to the lease holder.
+    room_leases_.renew(*shard.redis, ids, [](const std::string& room_id, const std::string& owner) {
+        logger::warn("room " + room_id + " is also held by " + owner);
+    });
+}
+
+void WebSocketServer::write_checkpoints(Shard& shard) {
+    // A round starts every interval with the rooms PLAYING at that moment.
+    // If the last one hasn't drained, it carries on instead.
+    int round_ticks = std::max(1, cfg_.checkpoint_interval_ms * cfg_.tick_rate / 1000);
+    if (shard.tick_count % round_ticks == 0) {
+        if (!shard.checkpoint_queue.empty()) {
+            shard.checkpoint_rounds_late.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            for (const auto& [id, room] : shard.rooms) {
+                if (room->state() == game::RoomState::PLAYING) shard.checkpoint_queue.push_back(id);
+            }
+        }
+    }
+    if (shard.checkpoint_queue.empty() || !shard.redis->connected()) return;
+
+    auto started = std::chrono::steady_clock::now();
+    std::string ttl = std::to_string(std::max(1, cfg_.checkpoint_ttl_seconds));
+    std::vector<std::pair<storage::AsyncRedisClient::Command, storage::AsyncRedisClient::Callback>> batch;
+
+    int budget = std::max(1, cfg_.checkpoint_rooms_per_tick);
+    uint64_t bytes = 0;
+    while (budget > 0 && !shard.checkpoint_queue.empty()) {
+        std::string id = std::move(shard.checkpoint_queue.back());
+        shard.checkpoint_queue.pop_back();
+
+        // Gone, finished or moved to another shard since the round began
+        auto* room = get_room(shard, id);
+        if (!room) continue;
+        shard.checkpoint_buf.clear();
+        if (!room->write_checkpoint(shard.checkpoint_buf)) continue;
+
+        bytes += shard.checkpoint_buf.size();
+        batch.push_back({{"SET", checkpoint_key(id), shard.checkpoint_buf, "EX", ttl}, {}});
+        budget--;
+    }
+    if (batch.empty()) return;
+
+    shard.checkpoints_written.fetch_add(batch.size(), std::memory_order_relaxed);
+    shard.checkpoint_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    shard.redis->pipeline(std::move(batch));
+    shard.checkpoint_cost.record_since(started);
+}
+
+WebSocketServer::Capacity WebSocketServer::capacity(int busiest_tick_us, uint64_t lag_max_us, int players) const {
+    if (draining()) return {};  // taking nothing new
+
+    double tick_budget_us = tick_dt_ * 1e6;
+    int room_limit = std::max(1, cfg_.max_rooms);
+    int seat_limit = std::max(1, cfg_.max_rooms * cfg_.max_players_per_room);
+
+    Capacity c;
+    c.tick_free = std::clamp(1.0 - busiest_tick_us / tick_budget_us, 0.0, 1.0);
+    c.rooms_free = std::clamp(1.0 - static_cast<double>(room_count_.load(std::memory_order_relaxed)) / room_limit, 0.0, 1.0);
+    c.seats_free = std::clamp(1.0 - static_cast<double>(players) / seat_limit, 0.0, 1.0);
+    c.lag_factor = std::clamp(1.0 - static_cast<double>(lag_max_us) / (CAPACITY_LAG_TICKS * tick_budget_us), 0.0, 1.0);
+    c.score = std::min({c.tick_free, c.rooms_free, c.seats_free}) * c.lag_factor;
+    return c;
+}
+
+std::string WebSocketServer::capacity_json() const {
+    // Lag since the last status publish, without resetting it
+    int players = 0;
+    int busiest_us = 0;
+    uint64_t lag_max = 0;
+    for (const auto& s : shards_) {
+        players += s->stat_players.load(std::memory_order_relaxed);
+        busiest_us = std::max(busiest_us, s->stat_tick_us.load(std::memory_order_relaxed));
+        lag_max = std::max(lag_max, s->stat_tick_lag_max_us.load(std::memory_order_relaxed));
+    }
+    auto cap = capacity(busiest_us, lag_max, players);
+    auto round3 = [](double v) { return std::round(v * 1000.0) / 1000.0; };
+    nlohmann::json body = {
+        {"node", node_id_},
+        {"score", round3(cap.score)},
+        {"tick_free", round3(cap.tick_free)},
+        {"rooms_free", round3(cap.rooms_free)},
+        {"seats_free", round3(cap.seats_free)},
+        {"lag_factor", round3(cap.lag_factor)},
+        {"tick_us", busiest_us},
+        {"lag_ms", lag_max / 1000}
+    };
+    return body.dump();
+}
+
+void WebSocketServer::publish_status(Shard& shard) {
+    // Stopping (the records are withdrawn in drain()), or a newer process
+    // took over the listen sockets and now writes this node's records
+    if (shard.closing || handed_off_.load(std::memory_order_relaxed)) return;
+    if (shard.status_in_flight) {
+        shard.status_skipped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    auto started = std::chrono::steady_clock::now();
+
+    int ttl = std::max(1, (STATUS_TTL_INTERVALS * cfg_.status_interval_ms + 999) / 1000);
+    std::string ttl_str = std::to_string(ttl);
+    int64_t now = static_cast<int64_t>(std::time(nullptr));
+
+    int rooms = 0;
+    int playing = 0;
+    int players = 0;
+    uint64_t lag_max = 0;
+    int busiest_us = 0;
+    std::vector<std::pair<storage::AsyncRedisClient::Command, storage::AsyncRedisClient::Callback>> batch;
+    batch.reserve(shards_.size() + 2);
+
+    for (const auto& s : shards_) {
+        int r = s->stat_rooms.load(std::memory_order_relaxed);
+        int pl = s->stat_rooms_playing.load(std::memory_order_relaxed);
+        int p = s->stat_players.load(std::memory_order_relaxed);
+        int tick_us = s->stat_tick_us.load(std::memory_order_relaxed);
+        uint64_t lag = s->stat_tick_lag_max_us.exchange(0, std::memory_order_relaxed);
+        rooms += r;
+        playing += pl;
+        players += p;
+        lag_max = std::max(lag_max, lag);
+        busiest_us = std::max(busiest_us, tick_us);
+
+        nlohmann::json record = {
+            {"rooms", r},
+            {"playing", pl},
+            {"players", p},
+            {"tick_us", tick_us},
+            {"lag_ms", lag / 1000}
+        };
+        batch.push_back({{"SET", status_key() + ":shard:" + std::to_string(s->index), record.dump(), "EX", ttl_str}, {}});
+    }
+
+    // Headroom: rooms and seats left under MAX_ROOMS, and the share of the
+    // tick interval the busiest loop still has free
+    int room_limit = cfg_.max_rooms;
+    int seat_limit = cfg_.max_rooms * cfg_.max_players_per_room;
+    auto cap = capacity(busiest_us, lag_max, players);
+    nlohmann::json status = {
+        {"node", node_id_},
+        {"ts", now},
+        {"rooms_active", rooms},
+        {"rooms_playing", playing},
+        {"players", players},
+        {"tick_lag_ms", lag_max / 1000},
+        {"rooms_free", std::max(0, room_limit - room_count_.load(std::memory_order_relaxed))},
+        {"seats_free", std::max(0, seat_limit - players)},
+        {"tick_free", std::round(cap.tick_free * 100.0) / 100.0},
+        {"capacity", std::round(cap.score * 1000.0) / 1000.0},
+        {"draining", draining()},
+        {"loops", shards_.size()}
+    };
+    batch.push_back({{"EVAL", CAPACITY_SCRIPT, "2", "server:capacity", "server:capacity:seen",
+                      node_id_, std::to_string(cap.score), std::to_string(now), std::to_string(now - ttl), ttl_str}, {}});
+    batch.push_back({{"SET", status_key(), status.dump(), "EX", ttl_str},
+                     [&shard](const storage::RedisReply& reply) {
+        shard.status_in_flight = false;
+        if (!reply.ok()) logger::warn("status publish failed" + (reply.str.empty() ? "" : ": " + reply.str));
+    }});
+
+    shard.status_in_flight = true;
+    shard.redis->pipeline(std::move(batch));
+    shard.status_publish.record_since(started);
+}
+
+// ── JWT secret rotation ─────────────────────────────
+
+void WebSocketServer::watch_jwt_secret(Shard& shard) {
+    if (cfg_.jwt_rotate_channel.empty() && cfg_.jwt_poll_seconds <= 0) return;
+
+    if (!cfg_.jwt_rotate_channel.empty()) {
+        shard.redis_sub = std::make_unique<storage::AsyncRedisClient>(
+            uWS::Loop::get(), cfg_.redis_addr, cfg_.redis_port, redis_password_);
+        shard.redis_sub->subscribe(cfg_.jwt_rotate_channel, [this, &shard](const storage::RedisReply&) {
+            // The message only says "re-read"; the secret itself stays in jwt:secret
+            check_jwt_secret(shard);
+        });
+        shard.redis_sub->start();
+    }
+
+    // Polls, and retires the previous secret once its overlap is over, so
+    // tokens cached under it go too
+    struct TimerData {
+        WebSocketServer* server;
+        Shard* shard;
+    };
+    int period_ms = 1000 * (cfg_.jwt_poll_seconds > 0 ? cfg_.jwt_poll_seconds : JWT_RETIRE_CHECK_SECONDS);
+    auto* timer = us_create_timer((struct us_loop_t*) uWS::Loop::get(), 0, sizeof(TimerData));
+    TimerData td{this, &shard};
+    memcpy(us_timer_ext(timer), &td, sizeof(TimerData));
+    shard.timers.push_back(timer);
+    us_timer_set(timer, [](struct us_timer_t* t) {
+        TimerData td;
+        memcpy(&td, us_timer_ext(t), sizeof(TimerData));
+        if (td.server->jwt_keys_.expire_previous(static_cast<int64_t>(std::time(nullptr)))) {
+            logger::info("previous JWT secret retired");
+        }
+        if (td.server->cfg_.jwt_poll_seconds > 0) td.server->check_jwt_secret(*td.shard);
+    }, period_ms, period_ms);
+
+    logger::info("watching jwt:secret"
+                 + (cfg_.jwt_rotate_channel.empty() ? "" : " (channel " + cfg_.jwt_rotate_channel + ")")
+                 + (cfg_.jwt_poll_seconds > 0 ? " every " + std::to_string(cfg_.jwt_poll_seconds) + "s" : ""));
+}
+
+void WebSocketServer::check_jwt_secret(Shard& shard) {
+    if (shard.jwt_check_in_flight) return;
+    shard.jwt_check_in_flight = true;
+    shard.redis->get("jwt:secret", [this, &shard](const storage::RedisReply& reply) {
+        shard.jwt_check_in_flight = false;
+        if (reply.type == storage::RedisReply::Type::NIL) {
+            logger::warn("jwt:secret missing from Redis — keeping the current secret");
+            return;
+        }
+        if (reply.type != storage::RedisReply::Type::STRING || reply.str.empty()) return;
+
+        bool was_enabled = jwt_keys_.get()->enabled();
+        if (!jwt_keys_.rotate(reply.str, cfg_.jwt_overlap_seconds)) return;
+        jwt_rotations_.fetch_add(1, std::memory_order_relaxed);
+        if (was_enabled) {
+            logger::info("JWT secret rotated (" + std::to_string(reply.str.size()) + " bytes); previous one accepted for "
+                         + std::to_string(cfg_.jwt_overlap_seconds) + "s");
+        } else {
+            logger::info("JWT secret loaded from Redis (" + std::to_string(reply.str.size()) + " bytes) — JWT validation enabled");
+        }
+    });
+}
+
+std::string WebSocketServer::info_json() const {
+    int rooms = 0;
+    int playing = 0;
+    int players = 0;
+    int tick = 0;
+    nlohmann::json per_shard = nlohmann::json::array();
+    for (const auto& shard : shards_) {
+        int r = shard->stat_rooms.load(std::memory_order_relaxed);
+        int p = shard->stat_players.load(std::memory_order_relaxed);
+        rooms += r;
+        playing += shard->stat_rooms_playing.load(std::memory_order_relaxed);
+        players += p;
+        tick = std::max(tick, shard->stat_tick.load(std::memory_order_relaxed));
+        per_shard.push_back({
+            {"rooms", r},
+            {"players", p},
+            {"tick_us", shard->stat_tick_us.load(std::memory_order_relaxed)}
+        });
+    }
+    uint64_t handoffs = 0;
+    uint64_t redirects = 0;
+    uint64_t checkpoints_written = 0;
+    uint64_t checkpoint_bytes = 0;
+    uint64_t checkpoints_restored = 0;
+    uint64_t checkpoint_rounds_late = 0;
+    uint64_t status_skipped = 0;
+    for (const auto& shard : shards_) {
+        handoffs += shard->handoffs_out.load(std::memory_order_relaxed);
+        redirects += shard->redirects.load(std::memory_order_relaxed);
+        checkpoints_written += shard->checkpoints_written.load(std::memory_order_relaxed);
+        checkpoint_bytes += shard->checkpoint_bytes.load(std::memory_order_relaxed);
+        checkpoints_restored += shard->checkpoints_restored.load(std::memory_order_relaxed);
+        checkpoint_rounds_late += shard->checkpoint_rounds_late.load(std::memory_order_relaxed);
+        status_skipped += shard->status_skipped.load(std::memory_order_relaxed);
+    }
+    auto jwt_keys = jwt_keys_.get();
+    nlohmann::json info = {
+        {"rooms_active", rooms},
+        {"rooms_playing", playing},
+        {"players_online", players},
+        {"tick", tick},
+        {"worker_threads", shards_.size()},
+        {"draining", draining()},
+        {"shards", per_shard},
+        {"handoffs", handoffs},
+        {"handoff_latency", metrics::latency_json(shards_, [](const auto& shard) -> const metrics::LatencyStat& {
+            return shard->handoff_latency;
+        })},
+        {"migrations", metrics::latency_json(shards_, [](const auto& shard) -> const metrics::LatencyStat& {
+            return shard->migration_latency;
+        })},
+        {"tick_lag", metrics::latency_json(shards_, [](const auto& shard) -> const metrics::LatencyStat& {
+            return shard->tick_lag;
+        })},
+        {"auth_latency", metrics::latency_json(shards_, [](const auto& shard) -> const metrics::LatencyStat& {
+            return shard->auth_latency;
+        })},
+        {"auth_queued", auth_pool_ ? auth_pool_->queued() : 0},
+        {"redirects", redirects},
+        {"inherited_accepts", inherited_accepts_.load(std::memory_order_relaxed)},
+        {"player_ids", game::player_ids().size()},
+        {"status_publish", metrics::latency_json(shards_, [](const auto& shard) -> const metrics::LatencyStat& {
+            return shard->status_publish;
+        })},
+        {"status_skipped", status_skipped},
+        {"checkpoints", {
+            {"written", checkpoints_written},
+            {"bytes", checkpoint_bytes},
+            {"restored", checkpoints_restored},
+            {"rounds_late", checkpoint_rounds_late},
+            {"cost", metrics::latency_json(shards_, [](const auto& shard) -> const metrics::LatencyStat& {
+                return shard->checkpoint_cost;
+            })}
+        }},
+        {"token_cache", {
+            {"hits", token_cache_.hits()},
+            {"misses", token_cache_.misses()},
+            {"size", token_cache_.size()}
+        }},
+        {"jwt", {
+            {"enabled", jwt_keys->enabled()},
+            {"rotations", jwt_rotations_.load(std::memory_order_relaxed)},
+            {"previous_accepted", jwt_keys->previous(static_cast<int64_t>(std::time(nullptr))) != nullptr}
+        }}
+    };
+    return info.dump();
+}
+
+bool WebSocketServer::all_shards_ticking() const {
+    // A shard whose game loop hasn't ticked for a second is wedged
+    int64_t now = steady_ms();
+    for (const auto& shard : shards_) {
+        if (now - shard->stat_last_tick_ms.load(std::memory_order_relaxed) > 1000) return false;
+    }
+    return true;
 }
 
 void WebSocketServer::run() {
-    uWS::App()
-        .ws<PerSocketData>("/ws/*", {
+    logger::info("starting " + std::to_string(shards_.size()) + " event loop"
+                 + (shards_.size() == 1 ? "" : "s"));
+
+    // Until a shard's timer runs, count it as ticking
+    for (auto& shard : shards_) {
+        shard->stat_last_tick_ms.store(steady_ms(), std::memory_order_relaxed);
+    }
+
+    // No shard listens until every loop exists to take handoffs
+    std::latch ready(static_cast<std::ptrdiff_t>(shards_.size()));
+
+    if (!cfg_.handoff_socket.empty()) {
+        takeover_ = handoff::request(cfg_.handoff_socket);
+        if (!takeover_.fds.empty()) {
+            logger::info("took over " + std::to_string(takeover_.fds.size())
+                         + " listen sockets from the previous process");
+            inherited_listener_ = std::make_unique<handoff::ListenAcceptor>(
+                std::move(takeover_.fds), [this, &ready, next = size_t{0}](int fd) mutable {
+                    ready.wait();  // every loop is up to adopt connections
+                    inherited_accepts_.fetch_add(1, std::memory_order_relaxed);
+
+                    // The sockets keep TCP_DEFER_ACCEPT, so the request line
+                    // is usually there; without it any loop will do
+                    char head[256];
+                    ssize_t n = ::recv(fd, head, sizeof(head), MSG_PEEK | MSG_DONTWAIT);
+                    std::optional<std::string_view> room_id;
+                    if (n > 0) room_id = room_from_request_line(std::string_view(head, static_cast<size_t>(n)));
+                    int owner = room_id ? owner_of(std::string(*room_id))
+                                        : static_cast<int>(next++ % shards_.size());
+                    adopt_on(*shards_[owner], fd, std::chrono::steady_clock::now());
+                });
+            handoff::confirm(takeover_);
+        }
+        start_handoff_server();
+    }
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < shards_.size(); ++i) {
+        threads.emplace_back([this, i, &ready] { run_shard(*shards_[i], ready); });
+    }
+    run_shard(*shards_[0], ready);
+
+    for (auto& t : threads) t.join();
+
+    if (handoff_server_) handoff_server_->stop();
+    if (inherited_listener_) inherited_listener_->stop();
+}
+
+void WebSocketServer::adopt_on(Shard& target, int fd, std::chrono::steady_clock::time_point accepted_at) {
+    Shard* t = &target;
+    static_cast<uWS::Loop*>(t->loop)->defer([t, fd, accepted_at]() {
+        if (!t->app || t->closed) {
+            ::close(fd);
+            return;
+        }
+        static_cast<uWS::App*>(t->app)->adoptSocket(fd);
+        t->handoff_latency.record_since(accepted_at);
+    });
+}
+
+void WebSocketServer::start_game_loop(Shard& shard) {
+    logger::info("tick_rate=" + std::to_string(cfg_.tick_rate)
+                 + " tick_dt=" + std::to_string(tick_dt_) + "s"
+                 + " jwt=" + (jwt_keys_.get()->enabled() ? "enabled" : "disabled"));
+
+    // ── Start game loop timer ────────────────
+    struct TimerData {
+        WebSocketServer* server;
+        Shard* shard;
+    };
+    int tick_ms = static_cast<int>(tick_dt_ * 1000.0f);
+    auto* timer = us_create_timer(
+        (struct us_loop_t*) uWS::Loop::get(), 0, sizeof(TimerData));
+    TimerData td{this, &shard};
+    memcpy(us_timer_ext(timer), &td, sizeof(TimerData));
+    shard.timers.push_back(timer);
+    us_timer_set(timer, [](struct us_timer_t* t) {
+        TimerData td;
+        memcpy(&td, us_timer_ext(t), sizeof(TimerData));
+        td.server->tick(*td.shard);
+    }, tick_ms, tick_ms);
+
+    logger::info("game loop started at " + std::to_string(cfg_.tick_rate) + " ticks/s");
+
+    // ── Status publishing (one loop for the node) ──
+    if (shard.index == 0 && shard.redis && cfg_.status_interval_ms > 0) {
+        auto* status_timer = us_create_timer(
+            (struct us_loop_t*) uWS::Loop::get(), 0, sizeof(TimerData));
+        memcpy(us_timer_ext(status_timer), &td, sizeof(TimerData));
+        shard.timers.push_back(status_timer);
+        us_timer_set(status_timer, [](struct us_timer_t* t) {
+            TimerData td;
+            memcpy(&td, us_timer_ext(t), sizeof(TimerData));
+            td.server->publish_status(*td.shard);
+        }, cfg_.status_interval_ms, cfg_.status_interval_ms);
+        logger::info("publishing " + status_key() + " every " + std::to_string(cfg_.status_interval_ms) + "ms");
+    }
+
+    shard.accepting.store(true);
+}
+
+// ── Hot restart ─────────────────────────────────────
+
+void WebSocketServer::start_handoff_server() {
+    handoff_server_ = std::make_unique<handoff::HandoffServer>(
+        cfg_.handoff_socket,
+        [this] { return listen_fds(); },
+        [this] { on_listen_handed_off(); });
+    if (!handoff_server_->start()) handoff_server_.reset();
+}
+
+std::vector<int> WebSocketServer::listen_fds() const {
+    for (const auto& shard : shards_) {
+        if (!shard->accepting.load()) return {};
+    }
+    if (inherited_listener_) return inherited_listener_->fds();
+
+    std::vector<int> fds;
+    for (const auto& shard : shards_) {
+        int fd = shard->listen_fd.load();
+        if (fd < 0) return {};
+        fds.push_back(fd);
+    }
+    return fds;
+}
+
+void WebSocketServer::on_listen_handed_off() {
+    // The new process holds the sockets now; this one stops accepting on
+    // them (closing its copies) and hands its rooms over right away:
+    // players who reconnect land on the new process, which must be the
+    // only one running their room
+    if (inherited_listener_) inherited_listener_->stop();
+    for (auto& s : shards_) {
+        Shard* shard = s.get();
+        static_cast<uWS::Loop*>(shard->loop)->defer([shard] {
+            shard->listen_fd.store(-1);
+            if (!shard->listen_socket) return;
+            us_listen_socket_close(0, static_cast<us_listen_socket_t*>(shard->listen_socket));
+            shard->listen_socket = nullptr;
+        });
+    }
+    handed_off_.store(true, std::memory_order_relaxed);
+    request_drain();
+}
+
+void WebSocketServer::run_shard(Shard& shard, std::latch& ready) {
+    uWS::App app;
+    shard.app = &app;
+    shard.loop = uWS::Loop::get();
+    current_shard = {this, &shard};
+
+    // This loop's own Redis connection, for anything the tick path or a
+    // handler needs from Redis; the blocking redis_ is for startup only
+    if (redis_.is_connected()) {
+        shard.redis = std::make_unique<storage::AsyncRedisClient>(
+            uWS::Loop::get(), cfg_.redis_addr, cfg_.redis_port, redis_password_);
+        shard.redis->start();
+        if (shard.index == 0) watch_jwt_secret(shard);
+    }
+
+    // Once close_shard() has begun this loop has no tick timer left and is
+    // about to exit, so nothing may be upgraded into it. Checked again at
+    // each step, as an upgrade can be parked on the auth pool or Redis (a
+    // stopped client still answers, with NONE) across the close.
+    auto refuse_if_closing = [&shard](auto* res) {
+        if (!shard.closing && !shard.closed) return false;
+        res->writeStatus("503 Service Unavailable")
+           ->writeHeader("Retry-After", std::to_string(DRAIN_RETRY_AFTER_SECONDS))
+           ->end("Server is shutting down, retry");
+        return true;
+    };
+
+    // Last step of the upgrade, once the player and the room's node are
+    // known: room checks and the handshake itself
+    auto finish_upgrade = [this, &shard, refuse_if_closing](auto* res, auto* context, PendingUpgrade& up) {
+        if (refuse_if_closing(res)) return;
+        const std::string& room_id = up.room_id;
+
+        // A room lives on exactly one loop. Connections are handed to
+        // the owner at accept time (see preOpen below); this only
+        // catches one whose request line hadn't arrived by then, or
+        // whose room moved while its token was being verified.
+        // Refuse it rather than split the room in two.
+        if (owner_of(room_id) != shard.index) {
+            logger::warn("upgrade for room " + room_id + " landed on shard "
+                         + std::to_string(shard.index) + ", owner is shard "
+                         + std::to_string(owner_of(room_id)));
+            res->writeStatus("503 Service Unavailable")
+               ->writeHeader("Retry-After", "0")
+               ->end("Room is served by another worker, retry");
+            return;
+        }
+
+        // Room is on its way here from another shard
+        if (!get_room(shard, room_id) && directory_.in_transit(room_id)) {
+            res->writeStatus("503 Service Unavailable")
+               ->writeHeader("Retry-After", "1")
+               ->end("Room is moving, retry");
+            return;
+        }
+
+        // Check room availability
+        auto* room = get_or_create_room(shard, room_id);
+        if (!room) {
+            res->writeStatus("503 Service Unavailable")
+               ->end("Server at max room capacity");
+            return;
+        }
+
+        // Check if player is already in this room (reconnect scenario)
+        game::PlayerHandle known = game::player_ids().find(up.player_id);
+        if (room->has_player(known)) {
+            if (void* sock = shard.socket_of(known)) {
+                auto* old_ws = static_cast<uWS::WebSocket<false, true, PerSocketData>*>(sock);
+                old_ws->getUserData()->player_id = "";  // prevent double-remove
+                old_ws->close();
+            }
+            room->remove_player(known);
+        }
+
+        if (room->is_full()) {
+            // Allow if player is reconnecting (saved in disconnected list)
+            bool is_reconnect = (room->state() == game::RoomState::PLAYING);
+            if (!is_reconnect) {
+                res->writeStatus("403 Forbidden")
+                   ->end("Room is full");
+                return;
+            }
+        }
+        if (room->state() == game::RoomState::FINISHED) {
+            res->writeStatus("403 Forbidden")
+               ->end("Room is finished");
+            return;
+        }
+
+        res->template upgrade<PerSocketData>(
+            {
+                .player_id = up.player_id,
+                .player = game::player_ids().acquire(up.player_id),  // released in .close
+                .player_name = up.player_name,
+                .room_id = room_id,
+                .wire_format = up.wire_format
+            },
+            up.key,
+            up.protocol,
+            up.extensions,
+            context
+        );
+    };
+
+    // A room this loop is to serve but doesn't have may have been running
+    // on a node that died: restore it from its checkpoint, if there is one,
+    // before the room checks. Only called once this node's lease claim
+    // succeeded, which proves no other node still runs the room.
+    auto restore_upgrade = [this, &shard, finish_upgrade](auto* res, auto* context, PendingUpgrade& up) {
+        if (!checkpoints_enabled() || !shard.redis || !shard.redis->connected()
+            || owner_of(up.room_id) != shard.index || get_room(shard, up.room_id)
+            || directory_.in_transit(up.room_id)) {
+            finish_upgrade(res, context, up);
+            return;
+        }
+
+        auto aborted = std::make_shared<bool>(false);
+        res->onAborted([aborted] { *aborted = true; });
+        shard.redis->get(checkpoint_key(up.room_id), [this, &shard, finish_upgrade, res, context, aborted,
+                                                      up = std::move(up)](const storage::RedisReply& reply) mutable {
+            if (*aborted) return;
+            // Another upgrade may have brought the room in meanwhile
+            if (reply.type == storage::RedisReply::Type::STRING && !get_room(shard, up.room_id)) {
+                restore_room(shard, up.room_id, reply.str);
+            }
+            res->cork([&] { finish_upgrade(res, context, up); });
+        });
+    };
+
+    // Second half of the upgrade, once the player is known. Runs on this
+    // loop, either inside the upgrade handler or deferred back to it after
+    // asynchronous JWT verification. A room this node doesn't have yet is
+    // first looked up in (and claimed through) the cross-node directory;
+    // if Redis is down or doesn't answer, the room is served here.
+    auto complete_upgrade = [this, &shard, refuse_if_closing, finish_upgrade, restore_upgrade](auto* res, auto* context,
+                                                                                            PendingUpgrade& up) {
+        if (refuse_if_closing(res)) return;
+
+        // Draining: only reconnects into a match still running here
+        if (draining()) {
+            auto* room = owner_of(up.room_id) == shard.index ? get_room(shard, up.room_id) : nullptr;
+            if (!room || room->state() != game::RoomState::PLAYING) {
+                res->writeStatus("503 Service Unavailable")
+                   ->writeHeader("Retry-After", std::to_string(DRAIN_RETRY_AFTER_SECONDS))
+                   ->end("Server is draining, retry");
+                return;
+            }
+        }
+
+        if (!room_leases_.enabled() || !shard.redis || !shard.redis->connected()
+            || owner_of(up.room_id) != shard.index || get_room(shard, up.room_id)) {
+            finish_upgrade(res, context, up);
+            return;
+        }
+
+        auto aborted = std::make_shared<bool>(false);
+        res->onAborted([aborted] { *aborted = true; });
+        room_leases_.claim(*shard.redis, up.room_id, [this, &shard, finish_upgrade, restore_upgrade, res, context,
+                                                      aborted, up = std::move(up)](const storage::RoomLeases::Owner& owner) mutable {
+            if (*aborted) return;
+            res->cork([&] {
+                // No answer: serve the room here, but never from a checkpoint
+                // another node may still be running
+                if (owner.node.empty()) {
+                    finish_upgrade(res, context, up);
+                    return;
+                }
+                if (owner.ours) {
+                    restore_upgrade(res, context, up);
+                    return;
+                }
+                // Another process on this node (the one we took over from in
+                // a hot restart, or one that crashed) still holds the room:
+                // wait for it to hand the room off or for its lease to lapse
+                if (owner.node == room_leases_.node_url()) {
+                    res->writeStatus("503 Service Unavailable")
+                       ->writeHeader("Retry-After", std::to_string(DRAIN_RETRY_AFTER_SECONDS))
+                       ->end("Room is still held by the previous process, retry");
+                    return;
+                }
+                shard.redirects.fetch_add(1, std::memory_order_relaxed);
+                logger::info("room " + up.room_id + " is on " + owner.node + ", redirecting player " + up.player_id);
+                res->writeStatus("307 Temporary Redirect")
+                   ->writeHeader("Location", owner.node + up.path)
+                   ->writeHeader("X-Room-Node", owner.node)
+                   ->end("Room is served by another node");
+            });
+        });
+    };
+
+    app.ws<PerSocketData>("/ws/*", {
             .compression = uWS::DISABLED,
             .maxPayloadLength = 16 * 1024,
             .idleTimeout = 120,
             .maxBackpressure = 256 * 1024,  // Increased from 64KB to 256KB
 
             // ── Upgrade (HTTP → WS handshake) ────────────────
-            .upgrade = [this](auto* res, auto* req, auto* context) {
+            .upgrade = [this, &shard, complete_upgrade](auto* res, auto* req, auto* context) {
                 auto url = std::string(req->getUrl());
                 auto query_str = std::string(req->getQuery());
                 auto full_url = url + "?" + query_str;
@@ -195,83 +1309,103 @@ void WebSocketServer::run() {
                     return;
                 }
 
-                // ── JWT validation ──────────────────────────
-                std::string player_id;
-                std::string player_name = "Player";
+                // Opt-in binary snapshots via Sec-WebSocket-Protocol. req is
+                // only valid during this call, so keep copies of the headers
+                // the handshake needs.
+                auto protocol = network::negotiate_wire_format(
+                    req->getHeader("sec-websocket-protocol"));
+                PendingUpgrade up;
+                up.room_id = std::move(room_id);
+                up.wire_format = protocol.format;
+                up.protocol = protocol.accepted;
+                up.key = req->getHeader("sec-websocket-key");
+                up.extensions = req->getHeader("sec-websocket-extensions");
+                up.path = url;
 
-                if (!jwt_secret_.empty() && !token.empty()) {
-                    auto payload = auth::validate_jwt(token, jwt_secret_);
-                    if (!payload) {
-                        res->writeStatus("401 Unauthorized")
-                           ->end("Invalid or expired token");
-                        return;
-                    }
-                    player_id = payload->sub;
-                    player_name = payload->username;
-                    logger::info("JWT validated | player=" + player_id + " name=" + player_name);
-                } else {
+                // ── JWT validation ──────────────────────────
+                auto keys = jwt_keys_.get();
+                if (!keys->enabled() || token.empty()) {
                     // Dev mode fallback: generate random ID
-                    player_id = generate_id();
-                    logger::debug("no JWT — generated player_id " + player_id);
-                }
-
-                // Check room availability
-                auto* room = get_or_create_room(room_id);
-                if (!room) {
-                    res->writeStatus("503 Service Unavailable")
-                       ->end("Server at max room capacity");
+                    up.player_id = generate_id();
+                    logger::debug("no JWT — generated player_id " + up.player_id);
+                    complete_upgrade(res, context, up);
                     return;
                 }
 
-                // Check if player is already in this room (reconnect scenario)
-                if (room->has_player(player_id)) {
-                    auto sock_it = player_sockets_.find(player_id);
-                    if (sock_it != player_sockets_.end()) {
-                        auto* old_ws = static_cast<uWS::WebSocket<false, true, PerSocketData>*>(sock_it->second);
-                        old_ws->getUserData()->player_id = "";  // prevent double-remove
-                        old_ws->close();
-                    }
-                    room->remove_player(player_id);
+                // Reconnect with a token this server already verified
+                if (auto cached = token_cache_.find(token, keys->generation)) {
+                    up.player_id = cached->sub;
+                    up.player_name = cached->username;
+                    logger::info("JWT validated (cached) | player=" + up.player_id + " name=" + up.player_name);
+                    complete_upgrade(res, context, up);
+                    return;
                 }
 
-                if (room->is_full()) {
-                    // Allow if player is reconnecting (saved in disconnected list)
-                    bool is_reconnect = (room->state() == game::RoomState::PLAYING);
-                    if (!is_reconnect) {
-                        res->writeStatus("403 Forbidden")
-                           ->end("Room is full");
+                if (!auth_pool_) {
+                    auto payload = keys->validate(token);
+                    if (!payload) {
+                        res->writeStatus("401 Unauthorized")
+                           ->end("Invalid or expired token");
                         return;
                     }
-                }
-                if (room->state() == game::RoomState::FINISHED) {
-                    res->writeStatus("403 Forbidden")
-                       ->end("Room is finished");
+                    token_cache_.insert(token, keys->generation, *payload);
+                    up.player_id = payload->sub;
+                    up.player_name = payload->username;
+                    logger::info("JWT validated | player=" + up.player_id + " name=" + up.player_name);
+                    complete_upgrade(res, context, up);
                     return;
                 }
 
-                res->template upgrade<PerSocketData>(
-                    {
-                        .player_id = player_id,
-                        .player_name = player_name,
-                        .room_id = room_id
-                    },
-                    req->getHeader("sec-websocket-key"),
-                    req->getHeader("sec-websocket-protocol"),
-                    req->getHeader("sec-websocket-extensions"),
-                    context
-                );
+                // Verify on the auth pool and finish the handshake back on
+                // this loop, so a reconnect storm doesn't hold up the tick
+                // timer. The client may hang up meanwhile; uWS then frees
+                // res, which onAborted records.
+                auto aborted = std::make_shared<std::atomic<bool>>(false);
+                res->onAborted([aborted] { aborted->store(true); });
+
+                auto* loop = static_cast<uWS::Loop*>(shard.loop);
+                auto received_at = std::chrono::steady_clock::now();
+                auth_pool_->submit([this, &shard, complete_upgrade, res, context, loop, aborted,
+                                    received_at, token = std::move(token), up = std::move(up)]() mutable {
+                    std::optional<auth::JwtPayload> payload;
+                    if (!aborted->load()) {
+                        // The keys as of now: a rotation may have landed while queued
+                        auto keys = jwt_keys_.get();
+                        payload = keys->validate(token);
+                        if (payload) token_cache_.insert(token, keys->generation, *payload);
+                    }
+
+                    loop->defer([&shard, complete_upgrade, res, context, aborted, received_at,
+                                 payload = std::move(payload), up = std::move(up)]() mutable {
+                        if (aborted->load()) return;
+                        shard.auth_latency.record_since(received_at);
+                        res->cork([&] {
+                            if (!payload) {
+                                res->writeStatus("401 Unauthorized")
+                                   ->end("Invalid or expired token");
+                                return;
+                            }
+                            up.player_id = payload->sub;
+                            up.player_name = payload->username;
+                            logger::info("JWT validated | player=" + up.player_id + " name=" + up.player_name);
+                            complete_upgrade(res, context, up);
+                        });
+                    });
+                });
             },
 
             // ── Connection opened ────────────────────────────
-            .open = [this](auto* ws) {
+            .open = [this, &shard](auto* ws) {
                 auto* data = ws->getUserData();
                 logger::info("ws open | player=" + data->player_id
                              + " name=" + data->player_name
-                             + " room=" + data->room_id);
+                             + " room=" + data->room_id
+                             + (data->wire_format == network::WireFormat::BINARY ? " wire=binary"
+                                : data->wire_format == network::WireFormat::BINARY_DELTA ? " wire=delta" : ""));
 
-                player_sockets_[data->player_id] = ws;
+                shard.set_socket(data->player, ws);
 
-                auto* room = get_room(data->room_id);
+                auto* room = get_room(shard, data->room_id);
                 if (!room) {
                     ws->send(network::make_error(500, "Room disappeared").dump(),
                              uWS::OpCode::TEXT);
@@ -279,12 +1413,12 @@ void WebSocketServer::run() {
                     return;
                 }
 
-                setup_room_broadcast(room);
-
                 game::Player player;
                 player.id = data->player_id;
+                player.handle = data->player;
                 player.name = data->player_name;
                 player.display_name = data->player_name;
+                player.wire_format = data->wire_format;
 
                 if (!room->add_player(player)) {
                     ws->send(network::make_error(403, "Could not join room").dump(),
@@ -293,25 +1427,35 @@ void WebSocketServer::run() {
                     return;
                 }
 
+                // Room broadcasts and the game_state stream for this wire format
+                ws->subscribe(room_topic(data->room_id, game::Room::Topic::ALL));
+                if (auto topic = game_state_topic(data->wire_format)) {
+                    ws->subscribe(room_topic(data->room_id, *topic));
+                }
+
                 // Send "connected" to the new player (include room state so frontend knows phase)
                 auto room_state_str = game::room_state_str(room->state());
-                room->send_to(data->player_id,
+                room->send_to(data->player,
                               network::make_connected(data->player_id, data->player_name,
                                                       room->current_tick(), room_state_str));
 
-                // Notify others
-                room->broadcast_except(data->player_id,
-                    network::make_player_joined(data->player_id, data->player_name));
+                // Notify others, with the slot so binary/delta clients mid-match
+                // can map the newcomer's lane
+                room->broadcast_except(data->player,
+                    network::make_player_joined(data->player_id, data->player_name,
+                                                room->get_player(data->player)->slot));
 
                 // Send appropriate state based on room phase
                 if (room->state() == game::RoomState::PLAYING) {
                     // Player reconnected during gameplay — send rejoin info (NOT game_start!)
                     // The frontend should handle "game_rejoin" differently from "game_start"
                     // and just resume receiving game_state without re-navigating
-                    room->send_to(data->player_id, {
+                    // "players" carries the id → slot mapping binary clients need
+                    room->send_to(data->player, {
                         {"type", "game_rejoin"},
                         {"tick", room->current_tick()},
                         {"round", 1},
+                        {"players", room->lobby_state()["players"]},
                         {"map_data", {
                             {"width", game::physics::MAP_WIDTH},
                             {"height", game::physics::MAP_HEIGHT},
@@ -326,9 +1470,21 @@ void WebSocketServer::run() {
             },
 
             // ── Message received ─────────────────────────────
-            .message = [this](auto* ws, std::string_view message, uWS::OpCode /*opCode*/) {
+            .message = [this, &shard](auto* ws, std::string_view message, uWS::OpCode /*opCode*/) {
                 auto* data = ws->getUserData();
 
+                // Hot path: player_input / snapshot_ack / ping straight off the frame
+                network::FastMessage fast;
+                if (network::parse_fast(message, fast)) {
+                    if (auto* room = get_room(shard, data->room_id)) {
+                        network::handle_fast_message(*room, data->player, fast);
+                    } else {
+                        ws->send(network::make_error(404, "Room not found").dump(),
+                                 uWS::OpCode::TEXT);
+                    }
+                    return;
+                }
+
                 auto parsed = network::parse_message(message);
                 if (!parsed) {
                     ws->send(network::make_error(400, "Invalid JSON").dump(),
@@ -336,14 +1492,14 @@ void WebSocketServer::run() {
                     return;
                 }
 
-                auto* room = get_room(data->room_id);
+                auto* room = get_room(shard, data->room_id);
                 if (!room) {
                     ws->send(network::make_error(404, "Room not found").dump(),
                              uWS::OpCode::TEXT);
                     return;
                 }
 
-                network::handle_message(*room, data->player_id, *parsed);
+                network::handle_message(*room, data->player, data->player_id, *parsed);
             },
 
             // ── Drain (backpressure relieved) ────────────────
@@ -356,82 +1512,156 @@ void WebSocketServer::run() {
             },
 
             // ── Connection closed ────────────────────────────
-            .close = [this](auto* ws, int code, std::string_view /*reason*/) {
+            .close = [this, &shard](auto* ws, int code, std::string_view /*reason*/) {
                 auto* data = ws->getUserData();
 
+                // Unregister before the handle goes back: once released it may
+                // be handed to another player by any loop. A replaced socket's
+                // entry already points at its successor.
+                if (shard.socket_of(data->player) == ws) shard.set_socket(data->player, nullptr);
+
                 // Skip if already cleaned up (reconnect scenario)
-                if (data->player_id.empty()) return;
+                if (data->player_id.empty()) {
+                    game::player_ids().release(data->player);
+                    return;
+                }
 
                 logger::info("ws close | player=" + data->player_id
                              + " room=" + data->room_id
                              + " code=" + std::to_string(code));
 
-                player_sockets_.erase(data->player_id);
+                ws->unsubscribe(room_topic(data->room_id, game::Room::Topic::ALL));
+                if (auto topic = game_state_topic(data->wire_format)) {
+                    ws->unsubscribe(room_topic(data->room_id, *topic));
+                }
 
-                auto* room = get_room(data->room_id);
+                auto* room = get_room(shard, data->room_id);
                 if (room) {
-                    room->remove_player(data->player_id);
+                    room->remove_player(data->player);
                     room->broadcast(network::make_player_left(data->player_id));
 
                     if (!room->is_empty()) {
                         room->broadcast(room->lobby_state());
                     }
                 }
+                game::player_ids().release(data->player);
 
-                cleanup_empty_rooms();
+                cleanup_empty_rooms(shard);
             }
         })
 
-        // ── Health check ─────────────────────────────────
-        .get("/health", [](auto* res, auto* /*req*/) {
-            res->writeHeader("Content-Type", "application/json")
-               ->end("{\"status\":\"ok\"}");
+        // ── Health check (every shard's game loop) ───────
+        .get("/health", [this](auto* res, auto* /*req*/) {
+            if (draining()) {
+                res->writeStatus("503 Service Unavailable")
+                   ->writeHeader("Content-Type", "application/json")
+                   ->end("{\"status\":\"draining\"}");
+            } else if (all_shards_ticking()) {
+                res->writeHeader("Content-Type", "application/json")
+                   ->end("{\"status\":\"ok\"}");
+            } else {
+                res->writeStatus("503 Service Unavailable")
+                   ->writeHeader("Content-Type", "application/json")
+                   ->end("{\"status\":\"degraded\"}");
+            }
         })
 
-        // ── Server info ──────────────────────────────────
+        // ── Server info (summed across shards) ───────────
         .get("/info", [this](auto* res, auto* /*req*/) {
-            int total_players = 0;
-            int playing_rooms = 0;
-            for (const auto& [_, room] : rooms_) {
-                total_players += room->player_count();
-                if (room->state() == game::RoomState::PLAYING) playing_rooms++;
-            }
-            nlohmann::json info = {
-                {"rooms_active", rooms_.size()},
-                {"rooms_playing", playing_rooms},
-                {"players_online", total_players},
-                {"tick", tick_count_}
-            };
             res->writeHeader("Content-Type", "application/json")
-               ->end(info.dump());
+               ->end(info_json());
+        })
+
+        // ── Capacity score, for a matchmaker polling nodes directly ──
+        .get("/capacity", [this](auto* res, auto* /*req*/) {
+            res->writeHeader("Content-Type", "application/json")
+               ->end(capacity_json());
         })
 
-        .listen(cfg_.port, [this](auto* listen_socket) {
+        // ── Room → node lookup (cross-node directory) ────
+        // Browsers don't follow redirects on a WebSocket handshake, so
+        // clients can ask here first and connect to `node` directly.
+        // Read-only and unauthenticated, so it never claims: `node` is null
+        // when nobody holds the room, the directory is off or Redis didn't
+        // answer, and then any node will do (the upgrade claims it).
+        .get("/rooms/:room/node", [this, &shard](auto* res, auto* req) {
+            std::string room_id(req->getParameter(0));
+            auto reply = [res, room_id](const std::string& owner) {
+                nlohmann::json body = {{"room", room_id}, {"node", nullptr}};
+                if (!owner.empty()) body["node"] = owner;
+                res->writeHeader("Content-Type", "application/json")
+                   ->end(body.dump());
+            };
+            if (!room_leases_.enabled() || !shard.redis || !shard.redis->connected() || draining()) {
+                reply("");
+                return;
+            }
+            auto aborted = std::make_shared<bool>(false);
+            res->onAborted([aborted] { *aborted = true; });
+            room_leases_.lookup(*shard.redis, room_id, [res, aborted, reply](const storage::RoomLeases::Owner& owner) {
+                if (*aborted) return;
+                res->cork([&] { reply(owner.node); });
+            });
+        })
+
+        // ── Cross-shard handoff ──────────────────────────
+        // The kernel picks the accepting loop (SO_REUSEPORT), but a room
+        // lives on exactly one. Before uWS reads anything, peek at the
+        // request line; if the room belongs to another shard, give the fd to
+        // that loop, which adopts it and parses the request from scratch.
+        // Same mechanism as uWS child apps (preOpen + defer + adoptSocket).
+        .preOpen([](struct us_socket_context_t* /*context*/, LIBUS_SOCKET_DESCRIPTOR fd) -> LIBUS_SOCKET_DESCRIPTOR {
+            auto [server, shard] = current_shard;
+            if (server->shards_.size() == 1) return fd;
+
+            char head[256];
+            ssize_t n = ::recv(fd, head, sizeof(head), MSG_PEEK | MSG_DONTWAIT);
+            if (n <= 0) return fd;
+
+            auto room_id = room_from_request_line(std::string_view(head, static_cast<size_t>(n)));
+            if (!room_id) return fd;  // /health, /info, or not all there yet
+
+            int owner = server->owner_of(std::string(*room_id));
+            if (owner == shard->index) return fd;
+
+            shard->handoffs_out.fetch_add(1, std::memory_order_relaxed);
+            adopt_on(*server->shards_[owner], fd, std::chrono::steady_clock::now());
+            return (LIBUS_SOCKET_DESCRIPTOR) -1;
+        });
+
+    ready.arrive_and_wait();
+
+    // Listen sockets taken over from the previous process are accepted on
+    // by inherited_listener_, which hands connections to the loops
+    if (inherited_listener_) {
+        start_game_loop(shard);
+        uWS::Loop::get()->run();
+    } else {
+        app.listen(cfg_.port, [this, &shard](auto* listen_socket) {
             if (listen_socket) {
-                logger::info("game server listening on port " + std::to_string(cfg_.port));
-                logger::info("tick_rate=" + std::to_string(cfg_.tick_rate)
-                             + " tick_dt=" + std::to_string(tick_dt_) + "s"
-                             + " jwt=" + (jwt_secret_.empty() ? "disabled" : "enabled"));
-
-                // ── Start game loop timer ────────────────
-                int tick_ms = static_cast<int>(tick_dt_ * 1000.0f);
-                auto* timer = us_create_timer(
-                    (struct us_loop_t*) uWS::Loop::get(), 0, sizeof(WebSocketServer*));
-                WebSocketServer* self = this;
-                memcpy(us_timer_ext(timer), &self, sizeof(WebSocketServer*));
-                us_timer_set(timer, [](struct us_timer_t* t) {
-                    WebSocketServer* srv;
-                    memcpy(&srv, us_timer_ext(t), sizeof(WebSocketServer*));
-                    srv->tick();
-                }, tick_ms, tick_ms);
-
-                logger::info("game loop started at " + std::to_string(cfg_.tick_rate) + " ticks/s");
+                shard.listen_socket = listen_socket;
+                int fd = us_poll_fd((struct us_poll_t*) listen_socket);
+                if (shards_.size() > 1) {
+                    // Accept only once the request has arrived, so preOpen
+                    // can see which room it is for
+                    int defer_secs = 1;
+                    ::setsockopt(fd, IPPROTO_TCP, TCP_DEFER_ACCEPT, &defer_secs, sizeof(defer_secs));
+                }
+                shard.listen_fd.store(fd);
+
+                logger::info("game server listening on port " + std::to_string(cfg_.port)
+                             + " (shard " + std::to_string(shard.index) + ")");
+                start_game_loop(shard);
             } else {
                 logger::error("failed to listen on port " + std::to_string(cfg_.port));
             }
         })
-
         .run();
+    }
+
+    shard.redis_sub.reset();
+    shard.redis.reset();
+    shard.app = nullptr;
 }
 
 } // namespace server
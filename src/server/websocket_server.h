@@ -3,54 +3,392 @@
 #include <string>
 #include <unordered_map>
 #include <memory>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <latch>
+#include <chrono>
+#include <optional>
+#include <string_view>
 
 #include "utils/config.h"
 #include "game/room.h"
+#include "network/wire_format.h"
 #include "storage/redis_client.h"
+#include "storage/async_redis_client.h"
+#include "storage/room_leases.h"
+#include "server/room_directory.h"
+#include "server/jwt_keys.h"
+#include "server/token_cache.h"
+#include "server/listen_handoff.h"
+#include "utils/metrics.h"
+#include "utils/work_pool.h"
+#include "utils/task_pool.h"
 
 namespace server {
 
 // Per-socket data attached to each WebSocket connection
 struct PerSocketData {
     std::string player_id;
+    game::PlayerHandle player = game::NO_PLAYER;  // interned player_id, held until close
     std::string player_name;
     std::string room_id;
+    network::WireFormat wire_format = network::WireFormat::JSON;
+};
+
+// ── Shard ───────────────────────────────────────────
+// One event-loop thread: its own uWS::App listening on the shared port
+// (SO_REUSEPORT), its own rooms, player sockets and game loop timer.
+// Everything here except the stat_ counters is only touched from the
+// shard's own thread.
+struct Shard {
+    int index = 0;
+
+    // The running uWS::App, for topic publishes, and its uWS::Loop, which
+    // other shards defer() onto (void* to avoid templates in the header)
+    void* app = nullptr;
+    void* loop = nullptr;
+
+    // Simulation lanes of every room on this shard (declared before rooms,
+    // which release their blocks on destruction)
+    game::SimWorld sim_world;
+    std::unordered_map<std::string, std::unique_ptr<game::Room>> rooms;
+    std::vector<game::Room*> stepped_rooms;  // per-tick scratch
+
+    // SIM_WORKERS threads that join this loop for the simulate phase of
+    // each tick (physics, snapshot encoding); null when SIM_WORKERS=0
+    std::unique_ptr<utils::WorkPool> sim_pool;
+
+    // Non-blocking Redis connection driven by this shard's loop; null when
+    // Redis was unreachable at startup
+    std::unique_ptr<storage::AsyncRedisClient> redis;
+
+    // Shard 0 only: a second connection subscribed to JWT_ROTATE_CHANNEL
+    // (a subscribed connection can't run other commands)
+    std::unique_ptr<storage::AsyncRedisClient> redis_sub;
+
+    // Raw WebSocket pointer of each player connected here, indexed by
+    // PlayerHandle (null = none); grows to the highest handle seen
+    std::vector<void*> player_sockets;
+
+    void* socket_of(game::PlayerHandle player) const {
+        return player < player_sockets.size() ? player_sockets[player] : nullptr;
+    }
+    void set_socket(game::PlayerHandle player, void* ws) {
+        if (player >= player_sockets.size()) player_sockets.resize(player + 1, nullptr);
+        player_sockets[player] = ws;
+    }
+
+    int tick_count = 0;
+    std::chrono::steady_clock::time_point last_tick_at{};
+    double tick_us_avg = 0;         // moving average of tick() wall time
+    int64_t rebalance_after_ms = 0;  // balancer cooldown (steady clock)
+
+    // Published once per tick for /info and /health, read from any shard
+    std::atomic<int> stat_rooms{0};
+    std::atomic<int> stat_rooms_playing{0};
+    std::atomic<int> stat_players{0};
+    std::atomic<int> stat_tick{0};
+    std::atomic<int64_t> stat_last_tick_ms{0};  // steady clock
+    std::atomic<int> stat_tick_us{0};           // tick_us_avg, rounded
+    std::atomic<uint64_t> stat_tick_lag_max_us{0};  // since the last status publish
+
+    // Connections accepted here for a room owned by another shard, and the
+    // accept → adopt latency of connections handed to this shard
+    std::atomic<uint64_t> handoffs_out{0};
+    metrics::LatencyStat handoff_latency;
+
+    // Upgrades sent to the node that holds their room (NODE_URL set)
+    std::atomic<uint64_t> redirects{0};
+
+    // Rooms moved to this shard by the balancer, detach → attach latency
+    metrics::LatencyStat migration_latency;
+
+    // How late the game loop timer fired against the tick interval, and
+    // upgrade request → handshake resumed on this loop for tokens verified
+    // on the auth pool
+    metrics::LatencyStat tick_lag;
+    metrics::LatencyStat auth_latency;
+
+    // server:status publishing, on shard 0 only: cost of building and
+    // queueing one publish, and whether the last one is still unanswered
+    metrics::LatencyStat status_publish;
+    bool status_in_flight = false;
+    std::atomic<uint64_t> status_skipped{0};
+
+    // Room checkpoints: ids of PLAYING rooms still to write this round
+    // (taken CHECKPOINT_ROOMS_PER_TICK at a time), the cost of each tick's
+    // batch on the loop, and checkpoints written / bytes / restored here
+    std::vector<std::string> checkpoint_queue;
+    std::string checkpoint_buf;
+    metrics::LatencyStat checkpoint_cost;
+    std::atomic<uint64_t> checkpoints_written{0};
+    std::atomic<uint64_t> checkpoint_bytes{0};
+    std::atomic<uint64_t> checkpoints_restored{0};
+    std::atomic<uint64_t> checkpoint_rounds_late{0};  // a round began with the last one unfinished
+
+    // Drain: set on this shard's first tick after a drain was requested.
+    // `closing` once its rooms are done (or the deadline passed) and their
+    // handoff to Redis is under way; `closed` once its sockets, timers and
+    // listen socket are gone and the loop is winding down.
+    bool draining = false;
+    bool closing = false;
+    bool closed = false;
+    int64_t drain_deadline_ms = 0;  // steady clock
+    int64_t close_by_ms = 0;        // give up waiting on the handoff
+
+    // us_listen_socket_t* and the us_timer_t*s that keep this loop running,
+    // closed when the shard shuts down
+    void* listen_socket = nullptr;
+    std::vector<void*> timers;
+
+    // For a hot restart handoff, read off the loop: the fd of
+    // listen_socket, and whether the shard has started taking connections
+    std::atomic<int> listen_fd{-1};
+    std::atomic<bool> accepting{false};
+
+    // JWT secret checks, on shard 0 only: whether a GET jwt:secret is
+    // unanswered, so notifications and polls don't stack up
+    bool jwt_check_in_flight = false;
 };
 
 class WebSocketServer {
 public:
     explicit WebSocketServer(const config::ServerConfig& cfg);
 
-    // Start listening — blocks the calling thread
+    // Start one event loop per shard and listen — blocks the calling
+    // thread, which runs shard 0
     void run();
 
-    // Called by the game loop timer every tick
-    void tick();
+    // Called by a shard's game loop timer every tick
+    void tick(Shard& shard);
+
+    // Starts draining: no new rooms or upgrades, running matches go on
+    // until they end or DRAIN_TIMEOUT_SECONDS pass, then run() returns. A
+    // second call cuts the wait short. Only stores an atomic, so it is
+    // safe from a signal handler.
+    void request_drain() { drain_requests_.fetch_add(1, std::memory_order_relaxed); }
+    bool draining() const { return drain_requests_.load(std::memory_order_relaxed) > 0; }
+
+    // Shard that owns a room, so every player of a room is served by the
+    // same loop: its home shard, unless the balancer has moved it
+    int owner_of(const std::string& room_id) const { return directory_.owner_of(room_id); }
 
 private:
+    // Runs one shard's uWS::App on the calling thread until it stops.
+    // Counts down `ready` once the loop can take handoffs, and waits for
+    // every other shard before listening.
+    void run_shard(Shard& shard, std::latch& ready);
+
+    // Room code from the start of a raw "GET /ws/<room>..." request, if the
+    // request line is complete
+    static std::optional<std::string_view> room_from_request_line(std::string_view head);
+
+    // Lanes per physics task when a shard's tick runs on its sim_pool
+    // (a multiple of 8 so only the last chunk has a scalar tail)
+    static constexpr size_t SIM_CHUNK_LANES = 1024;
+
     // Room management
-    game::Room* get_or_create_room(const std::string& room_id);
-    game::Room* get_room(const std::string& room_id);
-    void cleanup_empty_rooms();
+    game::Room* get_or_create_room(Shard& shard, const std::string& room_id);
+    game::Room* get_room(Shard& shard, const std::string& room_id);
+    void cleanup_empty_rooms(Shard& shard);
+
+    // Setup broadcast/publish callbacks for a room (on creation, and when
+    // it arrives from another shard)
+    void setup_room_broadcast(Shard& shard, game::Room* room);
+
+    // ── Load balancing ──────────────────────────────
+    // Every REBALANCE_EVERY_TICKS, the shard with the slowest ticks moves
+    // one room to the fastest if it is REBALANCE_RATIO times slower. Runs at
+    // the end of the hot shard's tick, so rooms move between ticks.
+    static constexpr int REBALANCE_EVERY_TICKS = 20;
+    static constexpr int REBALANCE_COOLDOWN_MS = 10000;
+    // Below this share of the tick interval a shard isn't under pressure
+    static constexpr double REBALANCE_MIN_LOAD = 0.2;
 
-    // Setup broadcast callback for a room
-    void setup_room_broadcast(game::Room* room);
+    void maybe_rebalance(Shard& shard);
+
+    // Detaches a room from `from` (its sockets are closed with
+    // CLOSE_ROOM_MOVED and its seats held) and attaches it on `to`'s loop.
+    // Called on `from`'s thread.
+    void migrate_room(Shard& from, Shard& to, const std::string& room_id);
+    static constexpr int CLOSE_ROOM_MOVED = 4001;
+
+    // ── Drain ───────────────────────────────────────
+    // Each shard notices a drain request on its next tick. Lobbies are
+    // closed with CLOSE_SERVER_DRAINING right away (there is no match to
+    // finish); upgrades other than reconnects into a running match get 503
+    // with Retry-After: DRAIN_RETRY_AFTER_SECONDS, /health reports
+    // "draining" and the capacity score drops to 0, so the fleet routes
+    // around the node. Once a shard has no rooms left, or at the deadline,
+    // it checkpoints what is still playing, releases the room leases (so
+    // another node can take the rooms over at once) and, when Redis has
+    // answered or after DRAIN_FLUSH_MS, closes its sockets and stops.
+    static constexpr int CLOSE_SERVER_DRAINING = 4002;
+    static constexpr int DRAIN_RETRY_AFTER_SECONDS = 2;
+    static constexpr int DRAIN_FLUSH_MS = 1000;
+
+    void drain(Shard& shard);
+    void close_shard(Shard& shard);
+
+    // ── Hot restart ─────────────────────────────────
+    // With HANDOFF_SOCKET set, run() first asks a previous process on that
+    // path for its listen sockets. If it gets them, the shards don't listen
+    // themselves: inherited_listener_ accepts and hands each connection to
+    // the loop of its room. Either way the process then serves handoffs on
+    // the path, and when a newer process takes the sockets over it stops
+    // accepting and drains with the wait cut short: it checkpoints its
+    // playing rooms, releases their leases and closes their sockets with
+    // CLOSE_SERVER_DRAINING. Leases name the process, so until then the new
+    // process answers reconnects for those rooms with 503 rather than
+    // start a second copy; once released it claims and restores them.
+    void start_handoff_server();
+    std::vector<int> listen_fds() const;
+    void on_listen_handed_off();
+
+    // Game loop and status timers; once the shard accepts connections
+    void start_game_loop(Shard& shard);
+
+    // Gives an accepted connection to `target`'s loop, which adopts it and
+    // parses the request from scratch
+    static void adopt_on(Shard& target, int fd, std::chrono::steady_clock::time_point accepted_at);
+
+    // Closes these players' sockets with `code`
+    void close_players(Shard& shard, const std::vector<game::PlayerHandle>& players, int code, std::string_view reason);
+
+    // ── Status publishing ───────────────────────────
+    // Every STATUS_INTERVAL_MS, shard 0 writes a compact status record for
+    // the node (server:status:<node>) and one per loop
+    // (server:status:<node>:shard:<i>), keyed by node_id_ so replicas don't
+    // overwrite each other, with SET EX, all in one pipelined batch on its AsyncRedisClient. A
+    // publish is skipped while the previous one is unanswered, so a slow
+    // Redis never piles up writes. Keys expire after STATUS_TTL_INTERVALS
+    // missed publishes.
+    static constexpr int STATUS_TTL_INTERVALS = 3;
+
+    void publish_status(Shard& shard);
+    std::string status_key() const { return "server:status:" + node_id_; }
+
+    // ── Capacity advertisement ──────────────────────
+    // How much more this node can take, 0 (full) to 1 (idle): the smallest
+    // of its free shares of the busiest loop's tick budget, of MAX_ROOMS
+    // and of the seats under it, scaled down by how late the tick timer ran
+    // (zero at CAPACITY_LAG_TICKS intervals late), and 0 while draining.
+    // Published with the status into the server:capacity sorted set
+    // (node → score; one member per node_id_), where the matchmaker picks
+    // the highest. server:capacity:seen holds each member's last publish:
+    // every publish prunes members not heard from for the status TTL, both
+    // sets expire that long after the last publish by anyone, and a node
+    // that stops withdraws its member.
+    static constexpr double CAPACITY_LAG_TICKS = 2.0;
+
+    struct Capacity {
+        double score;
+        double tick_free;
+        double rooms_free;
+        double seats_free;
+        double lag_factor;
+    };
+    Capacity capacity(int busiest_tick_us, uint64_t lag_max_us, int players) const;
+    std::string capacity_json() const;
+
+    // ── Cross-node room directory ───────────────────
+    // With NODE_URL set, an upgrade for a room this node doesn't have asks
+    // Redis who holds it (claiming it if nobody does) and is redirected
+    // there if that's another node. Each shard renews the leases on its
+    // rooms every ROOM_LEASE_SECONDS / LEASE_RENEWALS_PER_TTL.
+    static constexpr int LEASE_RENEWALS_PER_TTL = 3;
+
+    void renew_room_leases(Shard& shard);
+
+    // ── Room checkpoints ────────────────────────────
+    // Every CHECKPOINT_INTERVAL_MS each shard writes Room::write_checkpoint()
+    // of its PLAYING rooms to room:<id>:checkpoint (SET EX), at most
+    // CHECKPOINT_ROOMS_PER_TICK per tick in one pipelined batch, so the cost
+    // per tick stays bounded however many rooms there are. When a node dies
+    // its rooms' leases lapse; the first upgrade for one on another node
+    // finds the checkpoint and restores the room with every seat held, and
+    // players reattach as after a disconnect. A room that ends normally
+    // deletes its checkpoint.
+    //
+    // Only with NODE_URL: restoring is safe only once a lease claim shows
+    // no other node runs the room, and without leases nothing restores.
+    bool checkpoints_enabled() const { return cfg_.checkpoint_interval_ms > 0 && room_leases_.enabled(); }
+    void write_checkpoints(Shard& shard);
+    static std::string checkpoint_key(const std::string& room_id) { return "room:" + room_id + ":checkpoint"; }
+
+    // Adds a room rebuilt from `checkpoint` to the shard (within MAX_ROOMS);
+    // nullptr if it doesn't fit or the checkpoint is unusable
+    game::Room* restore_room(Shard& shard, const std::string& room_id, std::string_view checkpoint);
+
+    // ── JWT secret rotation ─────────────────────────
+    // Shard 0 re-reads jwt:secret whenever JWT_ROTATE_CHANNEL announces a
+    // new one (and when the subscription is re-established), and every
+    // JWT_POLL_SECONDS in case a message was lost. A changed secret becomes
+    // current in jwt_keys_; the old one stays accepted for
+    // JWT_OVERLAP_SECONDS.
+    // With polling off, how often the timer still checks for an overlap
+    // that has ended
+    static constexpr int JWT_RETIRE_CHECK_SECONDS = 60;
+
+    void watch_jwt_secret(Shard& shard);
+    void check_jwt_secret(Shard& shard);
+
+    // uWS pub/sub topic name for a room channel
+    static std::string room_topic(const std::string& room_id, game::Room::Topic topic);
 
     // Parse query string params from URL
     static std::unordered_map<std::string, std::string> parse_query(std::string_view url);
 
+    // Cross-shard /info and /health bodies, from the shards' stat_ counters
+    std::string info_json() const;
+    bool all_shards_ticking() const;
+
     config::ServerConfig cfg_;
-    std::unordered_map<std::string, std::unique_ptr<game::Room>> rooms_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    // AUTH_WORKERS threads verifying JWTs for every shard's upgrades;
+    // null when AUTH_WORKERS=0 (verify inline). Declared after shards_ so
+    // it stops before the loops its tasks defer onto go away.
+    std::unique_ptr<utils::TaskPool> auth_pool_;
+
+    // Listen sockets taken over from the previous process, and the
+    // previous process's connection to confirm on once they are served
+    handoff::Takeover takeover_;
+    std::unique_ptr<handoff::ListenAcceptor> inherited_listener_;
+    std::unique_ptr<handoff::HandoffServer> handoff_server_;
+    std::atomic<uint64_t> inherited_accepts_{0};
 
-    // Map player_id → their raw WebSocket pointer (void* to avoid template in header)
-    std::unordered_map<std::string, void*> player_sockets_;
+    // request_drain() calls so far
+    std::atomic<int> drain_requests_{0};
+    std::atomic<bool> handed_off_{false};  // a newer process took the listen sockets
 
-    // Redis for JWT secret and room config
+    // Rooms across all shards, for MAX_ROOMS
+    std::atomic<int> room_count_{0};
+
+    // Which shard each room lives on
+    RoomDirectory directory_;
+
+    // Redis for JWT secret and room config, blocking: startup only. Each
+    // shard has its own AsyncRedisClient for use from its loop.
     storage::RedisClient redis_;
-    std::string jwt_secret_;
+    std::string redis_password_;  // the password redis_ connected with, if any
+
+    // JWT secrets (current, and previous during a rotation), shared by every
+    // loop and the auth pool
+    auth::JwtKeyRing jwt_keys_;
+    std::atomic<uint64_t> jwt_rotations_{0};
+
+    // Tokens already verified, shared by every loop and the auth pool
+    auth::TokenCache token_cache_;
+
+    // room → node leases in Redis; disabled without NODE_URL
+    storage::RoomLeases room_leases_;
+
+    // This node in fleet-wide records: NODE_URL, or hostname:port
+    std::string node_id_;
 
     // Game loop state
-    int tick_count_ = 0;
     float tick_dt_ = 0.05f;  // 1/20 = 50ms
 };
 
@@ -0,0 +1,380 @@
+#include "storage/async_redis_client.h"
+#include "utils/logger.h"
+
+#include <libusockets.h>
+#include <hiredis/hiredis.h>
+
+#include <algorithm>
+#include <cstring>
+#include <netdb.h>
+#include <arpa/inet.h>
+
+namespace storage {
+
+namespace {
+
+// Numeric address for `host`, so reconnects from the loop never wait on DNS.
+// Falls back to the name itself, which uSockets then resolves per connect.
+std::string resolve(const std::string& host) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* result = nullptr;
+    if (getaddrinfo(host.c_str(), nullptr, &hints, &result) != 0 || !result) return host;
+
+    char buf[INET6_ADDRSTRLEN] = {};
+    const void* addr = result->ai_family == AF_INET6
+        ? static_cast<const void*>(&reinterpret_cast<sockaddr_in6*>(result->ai_addr)->sin6_addr)
+        : static_cast<const void*>(&reinterpret_cast<sockaddr_in*>(result->ai_addr)->sin_addr);
+    std::string out = inet_ntop(result->ai_family, addr, buf, sizeof(buf)) ? buf : host;
+    freeaddrinfo(result);
+    return out;
+}
+
+RedisReply convert(const redisReply* r) {
+    RedisReply out;
+    switch (r->type) {
+        case REDIS_REPLY_STRING:  out.type = RedisReply::Type::STRING; break;
+        case REDIS_REPLY_STATUS:  out.type = RedisReply::Type::STATUS; break;
+        case REDIS_REPLY_ERROR:   out.type = RedisReply::Type::ERROR; break;
+        case REDIS_REPLY_INTEGER: out.type = RedisReply::Type::INTEGER; break;
+        case REDIS_REPLY_ARRAY:   out.type = RedisReply::Type::ARRAY; break;
+        default:                  out.type = RedisReply::Type::NIL; break;
+    }
+    if (r->str) out.str.assign(r->str, r->len);
+    out.integer = r->integer;
+    if (r->type == REDIS_REPLY_ARRAY) {
+        out.elements.reserve(r->elements);
+        for (size_t i = 0; i < r->elements; ++i) out.elements.push_back(convert(r->element[i]));
+    }
+    return out;
+}
+
+// RESP array of bulk strings
+std::string encode(const AsyncRedisClient::Command& args) {
+    size_t size = 16;
+    for (const auto& a : args) size += a.size() + 16;
+    std::string out;
+    out.reserve(size);
+    out += '*';
+    out += std::to_string(args.size());
+    out += "\r\n";
+    for (const auto& a : args) {
+        out += '$';
+        out += std::to_string(a.size());
+        out += "\r\n";
+        out += a;
+        out += "\r\n";
+    }
+    return out;
+}
+
+AsyncRedisClient* client_of(us_socket_t* s) {
+    return *static_cast<AsyncRedisClient**>(us_socket_context_ext(0, us_socket_context(0, s)));
+}
+
+} // namespace
+
+// ── uSockets handlers ───────────────────────────────
+
+struct AsyncRedisClient::Handlers {
+    static us_socket_t* on_open(us_socket_t* s, int /*is_client*/, char* /*ip*/, int /*ip_length*/) {
+        auto* client = client_of(s);
+        client->socket_ = s;
+        client->on_open();
+        return s;
+    }
+
+    static us_socket_t* on_data(us_socket_t* s, char* data, int length) {
+        client_of(s)->on_data(data, length);
+        return s;
+    }
+
+    static us_socket_t* on_writable(us_socket_t* s) {
+        client_of(s)->on_writable();
+        return s;
+    }
+
+    static us_socket_t* on_close(us_socket_t* s, int /*code*/, void* /*reason*/) {
+        client_of(s)->on_closed();
+        return s;
+    }
+
+    static us_socket_t* on_end(us_socket_t* s) {
+        return us_socket_close(0, s, 0, nullptr);
+    }
+
+    static us_socket_t* on_timeout(us_socket_t* s) {
+        logger::warn("redis: connect timed out");
+        return us_socket_close(0, s, 0, nullptr);
+    }
+
+    // uSockets closes the socket itself afterwards, without on_close
+    static us_socket_t* on_connect_error(us_socket_t* s, int /*code*/) {
+        auto* client = client_of(s);
+        client->socket_ = nullptr;
+        client->schedule_reconnect();
+        return s;
+    }
+
+    static void on_timer(us_timer_t* t) {
+        (*static_cast<AsyncRedisClient**>(us_timer_ext(t)))->connect();
+    }
+};
+
+AsyncRedisClient::AsyncRedisClient(void* loop, const std::string& host, int port, const std::string& password)
+    : loop_(loop), host_(host), address_(resolve(host)), port_(port), password_(password) {}
+
+AsyncRedisClient::~AsyncRedisClient() {
+    stop();
+}
+
+void AsyncRedisClient::start() {
+    if (context_ || stopped_) return;
+    auto* loop = static_cast<us_loop_t*>(loop_);
+
+    us_socket_context_options_t options{};
+    auto* ctx = us_create_socket_context(0, loop, sizeof(AsyncRedisClient*), options);
+    *static_cast<AsyncRedisClient**>(us_socket_context_ext(0, ctx)) = this;
+    us_socket_context_on_open(0, ctx, Handlers::on_open);
+    us_socket_context_on_data(0, ctx, Handlers::on_data);
+    us_socket_context_on_writable(0, ctx, Handlers::on_writable);
+    us_socket_context_on_close(0, ctx, Handlers::on_close);
+    us_socket_context_on_end(0, ctx, Handlers::on_end);
+    us_socket_context_on_timeout(0, ctx, Handlers::on_timeout);
+    us_socket_context_on_connect_error(0, ctx, Handlers::on_connect_error);
+    context_ = ctx;
+
+    auto* timer = us_create_timer(loop, 0, sizeof(AsyncRedisClient*));
+    *static_cast<AsyncRedisClient**>(us_timer_ext(timer)) = this;
+    timer_ = timer;
+
+    connect();
+}
+
+void AsyncRedisClient::stop() {
+    if (stopped_) return;
+    stopped_ = true;
+
+    if (timer_) {
+        us_timer_close(static_cast<us_timer_t*>(timer_));
+        timer_ = nullptr;
+    }
+    if (socket_) {
+        us_socket_close(0, static_cast<us_socket_t*>(socket_), 0, nullptr);  // → on_closed()
+        socket_ = nullptr;
+    }
+    if (context_) {
+        us_socket_context_free(0, static_cast<us_socket_context_t*>(context_));
+        context_ = nullptr;
+    }
+    if (reader_) {
+        redisReaderFree(static_cast<redisReader*>(reader_));
+        reader_ = nullptr;
+    }
+
+    auto queued = std::move(queued_);
+    queued_.clear();
+    for (auto& [resp, cb] : queued) {
+        if (cb) cb(RedisReply{});
+    }
+}
+
+// ── Connection ──────────────────────────────────────
+
+void AsyncRedisClient::connect() {
+    if (stopped_ || socket_) return;
+    auto* s = us_socket_context_connect(0, static_cast<us_socket_context_t*>(context_),
+                                        address_.c_str(), port_, nullptr, 0, 0);
+    if (!s) {
+        schedule_reconnect();
+        return;
+    }
+    us_socket_timeout(0, s, CONNECT_TIMEOUT_SECONDS);
+    socket_ = s;
+}
+
+void AsyncRedisClient::schedule_reconnect() {
+    if (stopped_) return;
+    if (failures_++ == 0) {
+        logger::warn("redis: " + host_ + ":" + std::to_string(port_)
+                     + " unreachable, retrying with backoff");
+    }
+    us_timer_set(static_cast<us_timer_t*>(timer_), Handlers::on_timer, backoff_ms_, 0);
+    backoff_ms_ = std::min(backoff_ms_ * 2, BACKOFF_MAX_MS);
+}
+
+void AsyncRedisClient::on_open() {
+    auto* s = static_cast<us_socket_t*>(socket_);
+    us_socket_timeout(0, s, 0);
+    if (reader_) redisReaderFree(static_cast<redisReader*>(reader_));
+    reader_ = redisReaderCreate();
+
+    if (connects_++ > 0) reconnects_++;
+    logger::info("redis: async connection to " + host_ + ":" + std::to_string(port_) + " up");
+    ready_ = true;
+    failures_ = 0;
+    backoff_ms_ = BACKOFF_MIN_MS;
+
+    // AUTH goes first; everything queued while down follows in order
+    if (!password_.empty()) {
+        send(encode({"AUTH", password_}), [](const RedisReply& reply) {
+            if (!reply.ok()) logger::warn("redis: async auth failed: " + reply.str);
+        });
+    }
+    for (const auto& [channel, cb] : subscriptions_) {
+        out_ += encode({"SUBSCRIBE", channel});
+        sent_++;
+    }
+    auto queued = std::move(queued_);
+    queued_.clear();
+    for (auto& [resp, cb] : queued) send(std::move(resp), std::move(cb));
+    flush();
+}
+
+void AsyncRedisClient::on_data(const char* data, int length) {
+    auto* reader = static_cast<redisReader*>(reader_);
+    if (redisReaderFeed(reader, data, static_cast<size_t>(length)) != REDIS_OK) {
+        fail_connection(reader->errstr);
+        return;
+    }
+
+    while (socket_) {
+        void* raw = nullptr;
+        if (redisReaderGetReply(reader, &raw) != REDIS_OK) {
+            fail_connection(reader->errstr);
+            return;
+        }
+        if (!raw) return;  // need more data
+
+        auto* reply = static_cast<redisReply*>(raw);
+        RedisReply converted = convert(reply);
+        freeReplyObject(reply);
+
+        if (!subscriptions_.empty() && dispatch_push(converted)) continue;
+        if (waiting_.empty()) {
+            // Unsolicited; nothing to match. A failed SUBSCRIBE ends up here.
+            if (converted.type == RedisReply::Type::ERROR) logger::warn("redis: " + converted.str);
+            continue;
+        }
+        Callback cb = std::move(waiting_.front());
+        waiting_.pop_front();
+        // May issue commands, or stop() the client, which clears socket_
+        if (cb) cb(converted);
+    }
+}
+
+void AsyncRedisClient::fail_connection(const std::string& error) {
+    logger::error("redis: protocol error: " + error);
+
+    // The reader can't recover its place in the stream: nothing after this
+    // would match its command. Commands in flight fail with the error (not
+    // NONE, which on_closed() gives), and the connection starts over.
+    RedisReply reply;
+    reply.type = RedisReply::Type::ERROR;
+    reply.str = "protocol error: " + error;
+    auto waiting = std::move(waiting_);
+    waiting_.clear();
+
+    // Closed first, so commands the callbacks issue queue for the reconnect
+    if (socket_) us_socket_close(0, static_cast<us_socket_t*>(socket_), 0, nullptr);  // → on_closed()
+    for (auto& cb : waiting) {
+        if (cb) cb(reply);
+    }
+}
+
+void AsyncRedisClient::on_writable() {
+    flush();
+}
+
+void AsyncRedisClient::on_closed() {
+    bool was_ready = ready_;
+    socket_ = nullptr;
+    ready_ = false;
+    out_.clear();
+
+    // Commands in flight may or may not have run; their callers decide
+    auto waiting = std::move(waiting_);
+    waiting_.clear();
+    for (auto& cb : waiting) {
+        if (cb) cb(RedisReply{});
+    }
+
+    if (was_ready) failures_ = 0;
+    schedule_reconnect();
+}
+
+// ── Commands ────────────────────────────────────────
+
+void AsyncRedisClient::send(std::string resp, Callback cb) {
+    if (stopped_) {
+        if (cb) cb(RedisReply{});
+        return;
+    }
+    if (!ready_) {
+        if (queued_.size() >= MAX_QUEUED) {
+            if (cb) cb(RedisReply{});
+            return;
+        }
+        queued_.emplace_back(std::move(resp), std::move(cb));
+        return;
+    }
+    out_ += resp;
+    waiting_.push_back(std::move(cb));
+    sent_++;
+}
+
+void AsyncRedisClient::flush() {
+    if (!ready_ || out_.empty()) return;
+    auto* s = static_cast<us_socket_t*>(socket_);
+    int written = us_socket_write(0, s, out_.data(), static_cast<int>(out_.size()), 0);
+    // The rest goes out from on_writable()
+    if (written > 0) out_.erase(0, static_cast<size_t>(written));
+}
+
+void AsyncRedisClient::command(Command args, Callback cb) {
+    send(encode(args), std::move(cb));
+    flush();
+}
+
+void AsyncRedisClient::pipeline(std::vector<std::pair<Command, Callback>> commands) {
+    for (auto& [args, cb] : commands) send(encode(args), std::move(cb));
+    flush();
+}
+
+void AsyncRedisClient::get(const std::string& key, Callback cb) {
+    command({"GET", key}, std::move(cb));
+}
+
+void AsyncRedisClient::set_ex(const std::string& key, const std::string& value, int ttl_seconds, Callback cb) {
+    command({"SET", key, value, "EX", std::to_string(ttl_seconds)}, std::move(cb));
+}
+
+void AsyncRedisClient::subscribe(const std::string& channel, Callback on_push) {
+    subscriptions_.emplace_back(channel, std::move(on_push));
+    if (!ready_) return;  // on_open() subscribes
+    out_ += encode({"SUBSCRIBE", channel});
+    sent_++;
+    flush();
+}
+
+bool AsyncRedisClient::dispatch_push(const RedisReply& reply) {
+    if (reply.type != RedisReply::Type::ARRAY || reply.elements.size() != 3) return false;
+    const std::string& kind = reply.elements[0].str;
+    if (kind != "message" && kind != "subscribe") return false;
+
+    for (const auto& [channel, cb] : subscriptions_) {
+        if (channel != reply.elements[1].str) continue;
+        // May subscribe again (growing subscriptions_) or stop() the client
+        Callback handler = cb;
+        if (handler) handler(reply);
+        break;
+    }
+    return true;
+}
+
+void AsyncRedisClient::publish(const std::string& channel, const std::string& message, Callback cb) {
+    command({"PUBLISH", channel, message}, std::move(cb));
+}
+
+} // namespace storage
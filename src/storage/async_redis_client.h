@@ -0,0 +1,141 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <functional>
+#include <cstdint>
+
+namespace storage {
+
+// A Redis reply, copied out of hiredis so callers don't need its headers.
+// NONE means no reply arrived: the connection dropped with the command in
+// flight, the queue overflowed, or the client stopped.
+struct RedisReply {
+    enum class Type { NONE, NIL, STRING, STATUS, ERROR, INTEGER, ARRAY };
+
+    Type type = Type::NONE;
+    std::string str;  // STRING, STATUS, ERROR
+    long long integer = 0;
+    std::vector<RedisReply> elements;  // ARRAY
+
+    bool ok() const { return type != Type::NONE && type != Type::ERROR; }
+};
+
+// ── Non-blocking Redis client ───────────────────────
+// Lives on one event loop and is only touched from that loop's thread. The
+// connection is a uSockets socket in its own socket context, so reads and
+// writes are driven by the loop like any client socket; replies are parsed
+// with hiredis' reader and callbacks run on the loop.
+//
+// Commands are pipelined: they go out as soon as they are issued, without
+// waiting for earlier replies, and pipeline() writes a batch with one
+// syscall. Replies are matched to callbacks in order. While disconnected,
+// commands queue (up to MAX_QUEUED) and are sent after reconnecting, which
+// is retried with exponential backoff. Subscriptions are renewed on every
+// reconnect.
+class AsyncRedisClient {
+public:
+    using Callback = std::function<void(const RedisReply&)>;
+    using Command = std::vector<std::string>;
+
+    static constexpr size_t MAX_QUEUED = 10000;
+    static constexpr int BACKOFF_MIN_MS = 100;
+    static constexpr int BACKOFF_MAX_MS = 10000;
+    static constexpr int CONNECT_TIMEOUT_SECONDS = 5;
+
+    // `loop` is the us_loop_t* of the thread that will use the client
+    // (void* to avoid uSockets includes in the header). Resolves `host`
+    // here, so construct it off the loop or before it runs.
+    AsyncRedisClient(void* loop, const std::string& host, int port, const std::string& password = "");
+    ~AsyncRedisClient();
+
+    AsyncRedisClient(const AsyncRedisClient&) = delete;
+    AsyncRedisClient& operator=(const AsyncRedisClient&) = delete;
+
+    // Starts connecting; call on the loop thread
+    void start();
+
+    // Closes the connection for good. Callbacks still waiting get a NONE reply.
+    void stop();
+
+    // Queues one command; `cb` may be empty
+    void command(Command args, Callback cb = {});
+
+    // Queues several commands and writes them together
+    void pipeline(std::vector<std::pair<Command, Callback>> commands);
+
+    // Shorthands
+    void get(const std::string& key, Callback cb);
+    void set_ex(const std::string& key, const std::string& value, int ttl_seconds, Callback cb = {});
+    void publish(const std::string& channel, const std::string& message, Callback cb = {});
+
+    // Subscribes to `channel`. `on_push` gets the channel's pushes as they
+    // arrive: ["subscribe", channel, count] each time the subscription is
+    // (re)established, so the caller can catch up on what it missed while
+    // disconnected, and ["message", channel, payload] per message. A
+    // subscribed connection can't run other commands; use its own client.
+    void subscribe(const std::string& channel, Callback on_push);
+
+    bool connected() const { return ready_; }
+
+    // Commands written, and connections re-established after a drop
+    uint64_t commands_sent() const { return sent_; }
+    uint64_t reconnects() const { return reconnects_; }
+
+private:
+    // uSockets handlers (static, found through the context ext)
+    struct Handlers;
+    friend struct Handlers;
+
+    void connect();
+    void schedule_reconnect();
+    void on_open();
+    void on_data(const char* data, int length);
+    void on_writable();
+    void on_closed();
+
+    // Malformed reply: fails the commands in flight with an ERROR reply
+    // and closes the connection, which then reconnects with a new reader
+    void fail_connection(const std::string& error);
+
+    // Sends (or, while disconnected, queues) one RESP-encoded command
+    void send(std::string resp, Callback cb);
+    void flush();
+
+    // Hands a pub/sub push to its channel's callback; false if `reply` isn't one
+    bool dispatch_push(const RedisReply& reply);
+
+    void* loop_;            // us_loop_t*
+    void* context_ = nullptr;  // us_socket_context_t*
+    void* socket_ = nullptr;   // us_socket_t*, while connecting or connected
+    void* timer_ = nullptr;    // us_timer_t*, reconnect backoff
+    void* reader_ = nullptr;   // redisReader*
+
+    std::string host_;
+    std::string address_;  // host_ resolved
+    int port_;
+    std::string password_;
+
+    bool ready_ = false;     // connected (AUTH, if any, goes out first)
+    bool stopped_ = false;
+    int backoff_ms_ = BACKOFF_MIN_MS;
+    int failures_ = 0;       // consecutive failed connects
+
+    // Sent commands: RESP the socket hasn't taken yet, and the callbacks
+    // waiting for replies, in order. Dropped with the connection.
+    std::string out_;
+    std::deque<Callback> waiting_;
+
+    // Commands issued while disconnected, sent once the connection is up
+    std::deque<std::pair<std::string, Callback>> queued_;
+
+    // Channel → push callback, subscribed again after each reconnect
+    std::vector<std::pair<std::string, Callback>> subscriptions_;
+
+    uint64_t sent_ = 0;
+    uint64_t connects_ = 0;
+    uint64_t reconnects_ = 0;
+};
+
+} // namespace storage
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <utility>
+#include <random>
+#include <cstdio>
+
+#include "storage/async_redis_client.h"
+
+namespace storage {
+
+// ── Cross-node room ownership ───────────────────────
+// Which game server node a room lives on, shared through Redis so players
+// with the same room code meet on one node whichever replica the load
+// balancer picked. `room:<id>:node` holds the owner's public URL with a TTL
+// (the lease); the owner keeps extending it while the room exists and
+// deletes it when the room goes. A node that dies simply stops renewing,
+// so its rooms can be claimed elsewhere once the lease runs out.
+//
+// Claims and renewals are Lua scripts, so "read the owner, take the room if
+// nobody has it" is one atomic step in Redis and two nodes can't both win.
+//
+// The lease names the process too ("<url> <instance>"), not just the node:
+// during a hot restart two processes serve the same NODE_URL, and the new
+// one must not take a room the old one still runs.
+class RoomLeases {
+public:
+    struct Owner {
+        std::string node;   // the holder's URL, "" if Redis didn't answer
+        bool ours = false;  // held by this process
+    };
+    using OwnerCallback = std::function<void(const Owner& owner)>;
+
+    // `node_url` is how clients reach this node (e.g. wss://gs-1.example.com);
+    // empty disables leases (single node)
+    RoomLeases(std::string node_url, int ttl_seconds)
+        : node_url_(std::move(node_url)), holder_(node_url_ + " " + make_instance()),
+          ttl_(std::to_string(ttl_seconds)) {}
+
+    bool enabled() const { return !node_url_.empty(); }
+    const std::string& node_url() const { return node_url_; }
+
+    static std::string key(const std::string& room_id) { return "room:" + room_id + ":node"; }
+
+    // Owner of `room_id`, taking it for this process if nobody holds it
+    // (and extending the lease if this process already does)
+    void claim(AsyncRedisClient& redis, const std::string& room_id, OwnerCallback cb) const {
+        redis.command({"EVAL", CLAIM_SCRIPT, "1", key(room_id), holder_, ttl_},
+                      [this, cb = std::move(cb)](const RedisReply& reply) {
+            cb(owner(reply));
+        });
+    }
+
+    // Owner of `room_id` as it stands, without claiming anything
+    void lookup(AsyncRedisClient& redis, const std::string& room_id, OwnerCallback cb) const {
+        redis.get(key(room_id), [this, cb = std::move(cb)](const RedisReply& reply) {
+            cb(owner(reply));
+        });
+    }
+
+    // Renews the leases on rooms this process holds, in one pipelined
+    // batch, re-taking any that lapsed. `on_lost` gets each room another
+    // node or process holds instead, with that node's URL.
+    void renew(AsyncRedisClient& redis, const std::vector<std::string>& room_ids,
+               std::function<void(const std::string& room_id, const std::string& owner)> on_lost) const {
+        if (room_ids.empty()) return;
+        std::vector<std::pair<AsyncRedisClient::Command, AsyncRedisClient::Callback>> batch;
+        batch.reserve(room_ids.size());
+        for (const auto& id : room_ids) {
+            batch.push_back({{"EVAL", CLAIM_SCRIPT, "1", key(id), holder_, ttl_},
+                             [this, id, on_lost](const RedisReply& reply) {
+                if (reply.type == RedisReply::Type::STRING && reply.str != holder_) on_lost(id, owner(reply).node);
+            }});
+        }
+        redis.pipeline(std::move(batch));
+    }
+
+    // Gives `room_id` up, if this process still holds it
+    void release(AsyncRedisClient& redis, const std::string& room_id) const {
+        redis.command({"EVAL", RELEASE_SCRIPT, "1", key(room_id), holder_});
+    }
+
+private:
+    static std::string make_instance() {
+        std::random_device rd;
+        char buf[17];
+        std::snprintf(buf, sizeof(buf), "%08x%08x", rd(), rd());
+        return buf;
+    }
+
+    Owner owner(const RedisReply& reply) const {
+        if (reply.type != RedisReply::Type::STRING) return {};
+        return {reply.str.substr(0, reply.str.find(' ')), reply.str == holder_};
+    }
+
+    static constexpr const char* CLAIM_SCRIPT =
+        "local owner = redis.call('GET', KEYS[1]) "
+        "if not owner then "
+        "  redis.call('SET', KEYS[1], ARGV[1], 'EX', ARGV[2]) "
+        "  return ARGV[1] "
+        "end "
+        "if owner == ARGV[1] then redis.call('EXPIRE', KEYS[1], ARGV[2]) end "
+        "return owner";
+
+    static constexpr const char* RELEASE_SCRIPT =
+        "if redis.call('GET', KEYS[1]) == ARGV[1] then return redis.call('DEL', KEYS[1]) end "
+        "return 0";
+
+    std::string node_url_;
+    std::string holder_;  // lease value: node_url_ and this process's instance
+    std::string ttl_;  // lease length in seconds, as sent to Redis
+};
+
+} // namespace storage
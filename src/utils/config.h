@@ -10,10 +10,27 @@ struct ServerConfig {
     int tick_rate = 20;
     int max_rooms = 100;
     int max_players_per_room = 4;
+    int worker_threads = 1;  // event loops; 0 = one per core
+    int sim_workers = 0;  // extra simulation threads per event loop; 0 = tick on the loop alone
+    int auth_workers = 2;  // JWT verification threads shared by all loops; 0 = verify on the loop
+    int token_cache_size = 10000;  // verified JWTs kept until exp; 0 = off
+    std::string jwt_rotate_channel = "jwt:rotated";  // pub/sub channel announcing a new jwt:secret; empty = off
+    int jwt_poll_seconds = 60;  // re-read jwt:secret this often regardless; 0 = off
+    int jwt_overlap_seconds = 3600;  // the replaced secret stays accepted this long
+    float rebalance_ratio = 1.5f;  // move a room when a loop ticks this much slower; 0 = off
     std::string redis_addr = "localhost";
     int redis_port = 6379;
     std::string redis_password;
     std::string log_level = "info";
+    int status_interval_ms = 2000;  // server:status:<node> publish period; 0 = off
+    std::string node_url;  // how clients reach this node, for the cross-node room directory; empty = single node
+    int room_lease_seconds = 30;  // room → node entries expire this long after the owner stops renewing
+    int checkpoint_interval_ms = 1000;  // each playing room is checkpointed to Redis this often; 0 = off
+    int checkpoint_rooms_per_tick = 8;  // at most this many checkpoints written per loop per tick
+    int checkpoint_ttl_seconds = 120;  // a checkpoint outlives its room's last write this long
+    int drain_timeout_seconds = 300;  // on SIGTERM, rooms get this long to finish before the node exits
+    std::string handoff_socket;  // Unix socket for handing the listen sockets to a new process; empty = off
+    std::string physics_kernel = "auto";  // auto, scalar, sse4.1, avx2
 
     static ServerConfig from_env() {
         ServerConfig cfg;
@@ -26,6 +43,22 @@ struct ServerConfig {
             cfg.max_rooms = std::stoi(v);
         if (auto* v = std::getenv("MAX_PLAYERS_PER_ROOM"))
             cfg.max_players_per_room = std::stoi(v);
+        if (auto* v = std::getenv("WORKER_THREADS"))
+            cfg.worker_threads = std::stoi(v);
+        if (auto* v = std::getenv("SIM_WORKERS"))
+            cfg.sim_workers = std::stoi(v);
+        if (auto* v = std::getenv("AUTH_WORKERS"))
+            cfg.auth_workers = std::stoi(v);
+        if (auto* v = std::getenv("TOKEN_CACHE_SIZE"))
+            cfg.token_cache_size = std::stoi(v);
+        if (auto* v = std::getenv("JWT_ROTATE_CHANNEL"))
+            cfg.jwt_rotate_channel = v;
+        if (auto* v = std::getenv("JWT_POLL_SECONDS"))
+            cfg.jwt_poll_seconds = std::stoi(v);
+        if (auto* v = std::getenv("JWT_OVERLAP_SECONDS"))
+            cfg.jwt_overlap_seconds = std::stoi(v);
+        if (auto* v = std::getenv("REBALANCE_RATIO"))
+            cfg.rebalance_ratio = std::stof(v);
         if (auto* v = std::getenv("REDIS_ADDR")) {
             std::string addr = v;
             // Parse host:port format
@@ -39,8 +72,26 @@ struct ServerConfig {
         }
         if (auto* v = std::getenv("REDIS_PASSWORD"))
             cfg.redis_password = v;
+        if (auto* v = std::getenv("STATUS_INTERVAL_MS"))
+            cfg.status_interval_ms = std::stoi(v);
+        if (auto* v = std::getenv("NODE_URL"))
+            cfg.node_url = v;
+        if (auto* v = std::getenv("ROOM_LEASE_SECONDS"))
+            cfg.room_lease_seconds = std::stoi(v);
+        if (auto* v = std::getenv("CHECKPOINT_INTERVAL_MS"))
+            cfg.checkpoint_interval_ms = std::stoi(v);
+        if (auto* v = std::getenv("CHECKPOINT_ROOMS_PER_TICK"))
+            cfg.checkpoint_rooms_per_tick = std::stoi(v);
+        if (auto* v = std::getenv("CHECKPOINT_TTL_SECONDS"))
+            cfg.checkpoint_ttl_seconds = std::stoi(v);
+        if (auto* v = std::getenv("DRAIN_TIMEOUT_SECONDS"))
+            cfg.drain_timeout_seconds = std::stoi(v);
+        if (auto* v = std::getenv("HANDOFF_SOCKET"))
+            cfg.handoff_socket = v;
         if (auto* v = std::getenv("LOG_LEVEL"))
             cfg.log_level = v;
+        if (auto* v = std::getenv("PHYSICS_KERNEL"))
+            cfg.physics_kernel = v;
 
         return cfg;
     }
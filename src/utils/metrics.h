@@ -0,0 +1,50 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+
+namespace metrics {
+
+// ── Latency counter ─────────────────────────────────
+// Written by one or more loops, read by /info from any thread. Relaxed
+// atomics: the numbers are for dashboards, not for synchronization.
+struct LatencyStat {
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> total_us{0};
+    std::atomic<uint64_t> max_us{0};
+
+    void record(uint64_t us) {
+        count.fetch_add(1, std::memory_order_relaxed);
+        total_us.fetch_add(us, std::memory_order_relaxed);
+        uint64_t prev = max_us.load(std::memory_order_relaxed);
+        while (us > prev && !max_us.compare_exchange_weak(prev, us, std::memory_order_relaxed)) {}
+    }
+
+    void record_since(std::chrono::steady_clock::time_point start) {
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        record(us > 0 ? static_cast<uint64_t>(us) : 0);
+    }
+};
+
+// Sums several counters into {"count", "avg_us", "max_us"}
+template <typename Range, typename Get>
+nlohmann::json latency_json(const Range& range, Get&& get) {
+    uint64_t count = 0, total = 0, max = 0;
+    for (const auto& item : range) {
+        const LatencyStat& s = get(item);
+        count += s.count.load(std::memory_order_relaxed);
+        total += s.total_us.load(std::memory_order_relaxed);
+        max = std::max(max, s.max_us.load(std::memory_order_relaxed));
+    }
+    return {
+        {"count", count},
+        {"avg_us", count ? total / count : 0},
+        {"max_us", max}
+    };
+}
+
+} // namespace metrics
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace utils {
+
+// ── Fire-and-forget task pool ───────────────────────
+// submit() queues a task for the next free worker and returns at once.
+// Tasks that need to get back to an event loop do so themselves, with
+// Loop::defer. Tasks still queued when the pool is destroyed are dropped.
+class TaskPool {
+public:
+    explicit TaskPool(int workers) {
+        for (int i = 0; i < workers; ++i) {
+            threads_.emplace_back([this] { worker_loop(); });
+        }
+    }
+
+    ~TaskPool() {
+        {
+            std::lock_guard lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto& t : threads_) t.join();
+    }
+
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    void submit(std::function<void()> task) {
+        {
+            std::lock_guard lock(mutex_);
+            queue_.push_back(std::move(task));
+        }
+        cv_.notify_one();
+    }
+
+    // Tasks waiting for a worker, for /info
+    size_t queued() const {
+        std::lock_guard lock(mutex_);
+        return queue_.size();
+    }
+
+private:
+    void worker_loop() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock lock(mutex_);
+                cv_.wait(lock, [&] { return stop_ || !queue_.empty(); });
+                if (stop_) return;
+                task = std::move(queue_.front());
+                queue_.pop_front();
+            }
+            task();
+        }
+    }
+
+    std::vector<std::thread> threads_;
+    std::deque<std::function<void()>> queue_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+};
+
+} // namespace utils
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace utils {
+
+// ── Work-stealing fork/join pool ────────────────────
+// parallel_for(n, fn) runs fn(0..n-1) on the pool's workers plus the
+// calling thread and returns when every call has finished. Each
+// participant starts on its own contiguous range of indices, taken from
+// the front; when it runs dry it steals single indices from the back of
+// the others' ranges, so uneven items (big rooms, small rooms) even out.
+// One batch at a time per pool.
+class WorkPool {
+public:
+    explicit WorkPool(int workers) : slots_(static_cast<size_t>(workers) + 1) {
+        for (int i = 0; i < workers; ++i) {
+            threads_.emplace_back([this, i] { worker_loop(static_cast<size_t>(i) + 1); });
+        }
+    }
+
+    ~WorkPool() {
+        {
+            std::lock_guard lock(mutex_);
+            stop_ = true;
+        }
+        start_cv_.notify_all();
+        for (auto& t : threads_) t.join();
+    }
+
+    WorkPool(const WorkPool&) = delete;
+    WorkPool& operator=(const WorkPool&) = delete;
+
+    // Threads including the caller
+    size_t participants() const { return slots_.size(); }
+
+    void parallel_for(size_t n, const std::function<void(size_t)>& fn) {
+        if (n == 0) return;
+        if (threads_.empty() || n == 1) {
+            for (size_t i = 0; i < n; ++i) fn(i);
+            return;
+        }
+
+        // A participant only calls fn_ after taking an index from one of
+        // the ranges stored below, so it always sees this batch's fn
+        fn_.store(&fn);
+        remaining_.store(n);
+        size_t p = slots_.size();
+        for (size_t s = 0; s < p; ++s) {
+            slots_[s].range.store(pack(n * s / p, n * (s + 1) / p));
+        }
+
+        {
+            std::lock_guard lock(mutex_);
+            ++generation_;
+        }
+        start_cv_.notify_all();
+
+        participate(0);
+
+        std::unique_lock lock(mutex_);
+        done_cv_.wait(lock, [&] { return remaining_.load() == 0; });
+    }
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> range{0};  // begin in the low 32 bits, end in the high
+    };
+
+    static uint64_t pack(size_t begin, size_t end) {
+        return (static_cast<uint64_t>(end) << 32) | static_cast<uint32_t>(begin);
+    }
+
+    // Next index for participant `self`: own front first, then steal
+    bool take(size_t self, size_t& index) {
+        size_t p = slots_.size();
+        for (size_t k = 0; k < p; ++k) {
+            auto& range = slots_[(self + k) % p].range;
+            uint64_t cur = range.load();
+            while (true) {
+                uint32_t begin = static_cast<uint32_t>(cur);
+                uint32_t end = static_cast<uint32_t>(cur >> 32);
+                if (begin >= end) break;
+                bool own = k == 0;
+                uint64_t next = own ? pack(begin + 1, end) : pack(begin, end - 1);
+                if (range.compare_exchange_weak(cur, next)) {
+                    index = own ? begin : end - 1;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    void participate(size_t self) {
+        size_t index;
+        while (take(self, index)) {
+            (*fn_.load())(index);
+            if (remaining_.fetch_sub(1) == 1) {
+                std::lock_guard lock(mutex_);
+                done_cv_.notify_one();
+            }
+        }
+    }
+
+    void worker_loop(size_t self) {
+        uint64_t seen = 0;
+        while (true) {
+            {
+                std::unique_lock lock(mutex_);
+                start_cv_.wait(lock, [&] { return stop_ || generation_ != seen; });
+                if (stop_) return;
+                seen = generation_;
+            }
+            participate(self);
+        }
+    }
+
+    std::vector<Slot> slots_;  // [0] is the calling thread
+    std::vector<std::thread> threads_;
+    std::atomic<const std::function<void(size_t)>*> fn_{nullptr};
+    std::atomic<size_t> remaining_{0};
+
+    std::mutex mutex_;
+    std::condition_variable start_cv_;
+    std::condition_variable done_cv_;
+    uint64_t generation_ = 0;
+    bool stop_ = false;
+};
+
+} // namespace utils
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdio>
+
+// ── Minimal test harness ────────────────────────────
+// Each test is a standalone executable registered with ctest. CHECK()
+// reports a failed condition and carries on; test::result() is main()'s
+// return value, non-zero if any check failed.
+
+namespace test {
+inline int failures = 0;
+
+inline int result() {
+    if (failures) std::fprintf(stderr, "%d check(s) failed\n", failures);
+    return failures ? 1 : 0;
+}
+} // namespace test
+
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++test::failures;                                                    \
+        }                                                                        \
+    } while (0)
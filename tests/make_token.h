@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <nlohmann/json.hpp>
+
+#include "server/jwt.h"
+
+// HS256 tokens for tests, signed the way the Go API signs them
+namespace test {
+
+inline std::string base64url_encode(std::string_view data) {
+    static constexpr char ALPHABET[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+    std::string out;
+    size_t i = 0;
+    for (; i + 3 <= data.size(); i += 3) {
+        uint32_t v = (uint8_t(data[i]) << 16) | (uint8_t(data[i + 1]) << 8) | uint8_t(data[i + 2]);
+        for (int shift = 18; shift >= 0; shift -= 6) out += ALPHABET[(v >> shift) & 63];
+    }
+    if (size_t rest = data.size() - i; rest > 0) {
+        uint32_t v = uint8_t(data[i]) << 16;
+        if (rest == 2) v |= uint8_t(data[i + 1]) << 8;
+        out += ALPHABET[(v >> 18) & 63];
+        out += ALPHABET[(v >> 12) & 63];
+        if (rest == 2) out += ALPHABET[(v >> 6) & 63];
+    }
+    return out;
+}
+
+inline std::string make_token(const nlohmann::json& claims, std::string_view secret) {
+    std::string signed_part = base64url_encode(R"({"alg":"HS256","typ":"JWT"})") + "."
+                            + base64url_encode(claims.dump());
+    unsigned char sig[auth::HmacKey::DIGEST_SIZE];
+    auth::HmacKey(secret).sign(signed_part, sig);
+    return signed_part + "." + base64url_encode({reinterpret_cast<const char*>(sig), sizeof(sig)});
+}
+
+} // namespace test
@@ -0,0 +1,112 @@
+#include "check.h"
+#include "game/room.h"
+
+#include <memory>
+#include <string>
+
+using game::Player;
+using game::PlayerInput;
+using game::Room;
+
+static Player make_player(const std::string& id, const std::string& name) {
+    Player p;
+    p.id = id;
+    p.name = name;
+    p.display_name = name + "#1";
+    return p;
+}
+
+static game::PlayerHandle handle_of(const std::string& id) {
+    return game::player_ids().find(id);
+}
+
+// A PLAYING room with three players who have moved around for a while
+static std::unique_ptr<Room> playing_room() {
+    auto room = std::make_unique<Room>("room-1", 4);
+    room->add_player(make_player("p1", "alice"));
+    room->add_player(make_player("p2", "bob"));
+    room->add_player(make_player("p3", "carol"));
+    room->start_game();
+
+    PlayerInput left, jump;
+    left.add_action("left");
+    jump.add_action("jump");
+    jump.set_move_x(0.25f);
+    room->queue_input(handle_of("p1"), 1, left);
+    room->queue_input(handle_of("p2"), 1, jump);
+    for (int i = 0; i < 25; ++i) room->update(1.0f / 20.0f);
+    return room;
+}
+
+int main() {
+    auto room = playing_room();
+    CHECK(room->state() == game::RoomState::PLAYING);
+
+    std::string checkpoint;
+    CHECK(room->write_checkpoint(checkpoint));
+    CHECK(!checkpoint.empty());
+    CHECK(static_cast<uint8_t>(checkpoint[0]) == Room::CHECKPOINT_VERSION);
+
+    // Round trip: the restored room checkpoints to the same bytes
+    auto restored = Room::restore("room-1", checkpoint);
+    CHECK(restored != nullptr);
+    if (restored) {
+        CHECK(restored->state() == game::RoomState::PLAYING);
+        CHECK(restored->current_tick() == room->current_tick());
+        CHECK(restored->max_players() == room->max_players());
+        CHECK(restored->player_count() == 0);  // everyone held until they reattach
+
+        std::string again;
+        CHECK(restored->write_checkpoint(again));
+        CHECK(again == checkpoint);
+
+        // Players reattach to their old slots, and the match carries on exactly
+        // as it would have on the original room
+        for (const auto& [id, name] : {std::pair{"p1", "alice"}, {"p2", "bob"}, {"p3", "carol"}}) {
+            CHECK(restored->add_player(make_player(id, name)));
+            auto before = room->get_player(handle_of(id));
+            auto after = restored->get_player(handle_of(id));
+            CHECK(before && after && before->slot == after->slot);
+            CHECK(after && after->display_name == std::string(name) + "#1");
+        }
+        CHECK(restored->game_state() == room->game_state());
+
+        PlayerInput right;
+        right.add_action("right");
+        for (Room* r : {room.get(), restored.get()}) {
+            r->queue_input(handle_of("p3"), 30, right);
+            for (int i = 0; i < 10; ++i) r->update(1.0f / 20.0f);
+        }
+        std::string a, b;
+        room->write_checkpoint(a);
+        restored->write_checkpoint(b);
+        CHECK(a == b);
+    }
+
+    // Version check: a checkpoint from another format version is refused
+    {
+        std::string other = checkpoint;
+        other[0] = static_cast<char>(Room::CHECKPOINT_VERSION + 1);
+        CHECK(Room::restore("room-1", other) == nullptr);
+    }
+
+    // Malformed: truncated, empty, more seats than the room holds
+    CHECK(Room::restore("room-1", checkpoint.substr(0, checkpoint.size() - 1)) == nullptr);
+    CHECK(Room::restore("room-1", "") == nullptr);
+    {
+        std::string bad = checkpoint;
+        bad[7] = static_cast<char>(room->max_players() + 1);  // seat_count
+        CHECK(Room::restore("room-1", bad) == nullptr);
+    }
+
+    // Only a PLAYING room has a checkpoint, and nothing is written otherwise
+    {
+        Room waiting("room-2", 4);
+        waiting.add_player(make_player("p4", "dave"));
+        std::string out = "prefix";
+        CHECK(!waiting.write_checkpoint(out));
+        CHECK(out == "prefix");
+    }
+
+    return test::result();
+}
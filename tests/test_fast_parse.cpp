@@ -0,0 +1,126 @@
+#include "check.h"
+#include "network/message_handler.h"
+
+#include <exception>
+#include <string>
+#include <vector>
+
+using game::Player;
+using game::Room;
+
+// Two identical PLAYING rooms; one is fed through parse_fast() +
+// handle_fast_message(), the other through parse_message() +
+// handle_message(), and everything they send is recorded
+struct Side {
+    Room room{"room", 4};
+    std::vector<std::string> sent;
+
+    Side() {
+        room.set_broadcast_fn([this](game::PlayerHandle, const std::string& msg, bool) {
+            sent.push_back(msg);
+        });
+        for (const char* id : {"p1", "p2"}) {
+            Player p;
+            p.id = id;
+            p.name = id;
+            room.add_player(p);
+        }
+        room.start_game();
+        for (int i = 0; i < 10; ++i) room.update(1.0f / 20.0f);
+        sent.clear();
+    }
+};
+
+int main() {
+    Side fast, slow;
+    auto p1 = game::player_ids().find("p1");
+
+    const std::vector<std::string> messages = {
+        R"({"type":"ping"})",
+        R"({"type":"player_input","tick":11,"actions":["left","jump"]})",
+        R"({ "type" : "player_input" , "tick" : 12 , "actions" : [ "right" ] , "move_x" : -0.5 })",
+        R"({"type":"player_input","tick":13,"actions":["right","left"],"ack":4})",
+        R"({"tick":14,"type":"player_input","actions":[],"move_x":1})",
+        R"({"type":"player_input","tick":15,"actions":["jump",7,null,"fly"],"move_x":"fast"})",
+        R"({"type":"player_input","tick":16,"actions":"left","ack":6.5})",
+        R"({"type":"player_input","actions":["right"],"ack":"7","extra":{"a":[1,2,{"b":3}]}})",
+        R"({"type":"player_input","tick":18,"move_x":0.3,"ack":9})",
+        R"({"type":"snapshot_ack","tick":10})",
+        R"({"type":"snapshot_ack","tick":3})",
+        R"({"type":"snapshot_ack"})",
+    };
+
+    for (const auto& raw : messages) {
+        network::FastMessage msg;
+        bool parsed_fast = network::parse_fast(raw, msg);
+        CHECK(parsed_fast);
+        if (!parsed_fast) {
+            std::fprintf(stderr, "  not taken by parse_fast: %s\n", raw.c_str());
+            continue;
+        }
+        network::handle_fast_message(fast.room, p1, msg);
+
+        auto json = network::parse_message(raw);
+        CHECK(json.has_value());
+        if (json) network::handle_message(slow.room, p1, "p1", *json);
+
+        // Same replies, same per-player state, same simulation afterwards
+        CHECK(fast.sent == slow.sent);
+        auto a = fast.room.get_player(p1);
+        auto b = slow.room.get_player(p1);
+        CHECK(a && b);
+        if (a && b) {
+            CHECK(a->last_input_tick == b->last_input_tick);
+            CHECK(a->acked_tick == b->acked_tick);
+        }
+        fast.room.update(1.0f / 20.0f);
+        slow.room.update(1.0f / 20.0f);
+        std::string fa, sa;
+        fast.room.write_checkpoint(fa);
+        slow.room.write_checkpoint(sa);
+        CHECK(fa == sa);
+        if (fa != sa) std::fprintf(stderr, "  diverged after: %s\n", raw.c_str());
+    }
+
+    // Messages the fast path leaves to handle_message()
+    for (const char* raw : {
+             R"({"type":"chat_message","message":"hi"})",
+             R"({"type":"player_ready","ready":true})",
+             R"({"type":"player_input","tick":1.5})",
+             R"({"tick":1})",
+             R"({"type":"player_input","tick":1)",
+             R"([1,2,3])",
+         }) {
+        network::FastMessage msg;
+        CHECK(!network::parse_fast(raw, msg));
+    }
+
+    // Ticks of the wrong type: the fast path refuses them, and the slow path
+    // ignores the field instead of throwing out of the message handler
+    for (const char* raw : {
+             R"({"type":"snapshot_ack","tick":"x"})",
+             R"({"type":"snapshot_ack","tick":2.5})",
+             R"({"type":"snapshot_ack","tick":null})",
+             R"({"type":"player_input","tick":"x","actions":["left"]})",
+             R"({"type":"player_input","tick":[1],"ack":"x"})",
+         }) {
+        network::FastMessage msg;
+        CHECK(!network::parse_fast(raw, msg));
+
+        auto before = slow.room.get_player(p1);
+        auto json = network::parse_message(raw);
+        CHECK(json.has_value());
+        bool threw = false;
+        try {
+            if (json) CHECK(network::handle_message(slow.room, p1, "p1", *json));
+        } catch (const std::exception&) {
+            threw = true;
+        }
+        CHECK(!threw);
+        if (threw) std::fprintf(stderr, "  handle_message threw on: %s\n", raw);
+        auto after = slow.room.get_player(p1);
+        CHECK(before && after && before->acked_tick == after->acked_tick);
+    }
+
+    return test::result();
+}
@@ -0,0 +1,117 @@
+#include "check.h"
+#include "make_token.h"
+#include "server/jwt.h"
+
+#include <cstdio>
+#include <ctime>
+#include <string>
+#include <vector>
+
+using auth::detail::base64url_decode;
+using auth::detail::base64url_decoded_size;
+
+// Decodes `input`, nullopt on failure
+static std::optional<std::string> decode(std::string_view input) {
+    std::vector<uint8_t> out(base64url_decoded_size(input.size()) + 1);
+    int n = base64url_decode(input, out.data());
+    if (n < 0) return std::nullopt;
+    return std::string(reinterpret_cast<const char*>(out.data()), static_cast<size_t>(n));
+}
+
+static std::string hex(const unsigned char* data, size_t n) {
+    std::string out;
+    char buf[3];
+    for (size_t i = 0; i < n; ++i) {
+        std::snprintf(buf, sizeof(buf), "%02x", data[i]);
+        out += buf;
+    }
+    return out;
+}
+
+static std::string hmac_hex(std::string_view key, std::string_view data) {
+    unsigned char out[auth::HmacKey::DIGEST_SIZE];
+    auth::HmacKey k(key);
+    if (!k.valid() || !k.sign(data, out)) return "";
+    return hex(out, sizeof(out));
+}
+
+int main() {
+    // ── base64url: RFC 4648 §10 vectors, with and without padding ──
+    CHECK(decode("") == "");
+    CHECK(decode("Zg") == "f");
+    CHECK(decode("Zg==") == "f");
+    CHECK(decode("Zm8") == "fo");
+    CHECK(decode("Zm8=") == "fo");
+    CHECK(decode("Zm9v") == "foo");
+    CHECK(decode("Zm9vYg") == "foob");
+    CHECK(decode("Zm9vYmE") == "fooba");
+    CHECK(decode("Zm9vYmFy") == "foobar");
+
+    // URL-safe and standard alphabets both map 62/63
+    CHECK(decode("-_-_") == std::string("\xfb\xff\xbf", 3));
+    CHECK(decode("+/+/") == std::string("\xfb\xff\xbf", 3));
+
+    // Impossible length, characters outside the alphabet
+    CHECK(!decode("Z"));
+    CHECK(!decode("Zm9vY"));
+    CHECK(!decode("Zm9v!mFy"));
+    CHECK(!decode("Zm.v"));
+    CHECK(!decode("Zm9"  "\x80"));
+
+    // Round trip through the test encoder, every length up to two groups
+    {
+        std::string bytes;
+        for (int i = 0; i < 9; ++i) {
+            CHECK(decode(test::base64url_encode(bytes)) == bytes);
+            bytes += static_cast<char>(0xF0 + i);
+        }
+    }
+
+    // ── HMAC-SHA256: RFC 4231 test cases ──
+    // Case 1
+    CHECK(hmac_hex(std::string(20, '\x0b'), "Hi There")
+          == "b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7");
+    // Case 2: key shorter than the block
+    CHECK(hmac_hex("Jefe", "what do ya want for nothing?")
+          == "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843");
+    // Case 3
+    CHECK(hmac_hex(std::string(20, '\xaa'), std::string(50, '\xdd'))
+          == "773ea91e36800e46854db8ebd09181a72959098b3ef8c122d9635514ced565fe");
+    // Case 6: key longer than the block is hashed first
+    CHECK(hmac_hex(std::string(131, '\xaa'), "Test Using Larger Than Block-Size Key - Hash Key First")
+          == "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54");
+
+    // A pre-keyed HmacKey gives the same result on every call
+    {
+        auth::HmacKey key("Jefe");
+        unsigned char first[auth::HmacKey::DIGEST_SIZE], second[auth::HmacKey::DIGEST_SIZE];
+        CHECK(key.sign("what do ya want for nothing?", first));
+        CHECK(key.sign("what do ya want for nothing?", second));
+        CHECK(hex(first, sizeof(first)) == hex(second, sizeof(second)));
+        CHECK(!auth::HmacKey().valid());
+    }
+
+    // ── validate_jwt ──
+    auto now = static_cast<int64_t>(std::time(nullptr));
+    nlohmann::json claims = {{"sub", "player-1"}, {"username", "alice"}, {"exp", now + 3600}, {"iat", now}};
+    auto token = test::make_token(claims, "secret");
+    {
+        auto payload = auth::validate_jwt(token, std::string("secret"));
+        CHECK(payload && payload->sub == "player-1" && payload->username == "alice");
+        CHECK(payload && payload->exp == now + 3600);
+    }
+    CHECK(!auth::validate_jwt(token, std::string("other")));
+    CHECK(!auth::validate_jwt(token.substr(0, token.size() - 2), std::string("secret")));
+    CHECK(!auth::validate_jwt(test::make_token({{"sub", "p"}, {"exp", now - 10}}, "secret"), std::string("secret")));
+    CHECK(!auth::validate_jwt(test::make_token({{"username", "nobody"}}, "secret"), std::string("secret")));
+    CHECK(!auth::validate_jwt(std::string("no-dots"), std::string("secret")));
+
+    // The previous key is accepted while it's passed in
+    {
+        auth::HmacKey current("new"), previous("secret");
+        CHECK(auth::validate_jwt(token, current, &previous).has_value());
+        CHECK(!auth::validate_jwt(token, current, nullptr));
+    }
+
+    return test::result();
+}
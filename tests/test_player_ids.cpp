@@ -0,0 +1,67 @@
+#include "check.h"
+#include "game/player_ids.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+int main() {
+    using game::NO_PLAYER;
+    game::PlayerIds ids;
+
+    // Interning: the same id gives the same handle, a different id another
+    auto a = ids.acquire("player-a");
+    auto b = ids.acquire("player-b");
+    CHECK(a != NO_PLAYER);
+    CHECK(b != NO_PLAYER);
+    CHECK(a != b);
+    CHECK(ids.acquire("player-a") == a);
+    CHECK(ids.find("player-a") == a);
+    CHECK(ids.find("nobody") == NO_PLAYER);
+    CHECK(ids.size() == 2);
+
+    // "player-a" now has two references; the first release keeps it
+    ids.release(a);
+    CHECK(ids.find("player-a") == a);
+    CHECK(ids.retain(a) == a);
+    ids.release(a);
+    CHECK(ids.find("player-a") == a);
+
+    // The last release frees the handle, and the next new id reuses it
+    ids.release(a);
+    CHECK(ids.find("player-a") == NO_PLAYER);
+    CHECK(ids.size() == 1);
+    auto c = ids.acquire("player-c");
+    CHECK(c == a);
+    CHECK(ids.find("player-c") == c);
+    CHECK(ids.find("player-a") == NO_PLAYER);
+
+    // NO_PLAYER is never handed out, and retaining or releasing it is a no-op
+    CHECK(ids.retain(NO_PLAYER) == NO_PLAYER);
+    ids.release(NO_PLAYER);
+    CHECK(ids.size() == 2);
+
+    ids.release(b);
+    ids.release(c);
+    CHECK(ids.size() == 0);
+
+    // Handles stay dense under churn from several threads
+    {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&ids, t] {
+                for (int i = 0; i < 2000; ++i) {
+                    std::string id = "t" + std::to_string(t) + "-" + std::to_string(i % 8);
+                    auto h = ids.acquire(id);
+                    ids.release(h);
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+        CHECK(ids.size() == 0);
+        for (int i = 0; i < 32; ++i) ids.acquire("dense-" + std::to_string(i));
+        CHECK(ids.find("dense-31") <= 32);
+    }
+
+    return test::result();
+}
@@ -0,0 +1,114 @@
+#include "check.h"
+#include "make_token.h"
+#include "server/token_cache.h"
+
+#include <ctime>
+#include <string>
+
+static auth::JwtPayload payload(const std::string& sub, int64_t exp) {
+    auth::JwtPayload p;
+    p.sub = sub;
+    p.exp = exp;
+    return p;
+}
+
+int main() {
+    auto now = static_cast<int64_t>(std::time(nullptr));
+
+    // Hit and miss
+    {
+        auth::TokenCache cache(8);
+        CHECK(!cache.find("tok-a", 1));
+        cache.insert("tok-a", 1, payload("a", now + 3600));
+        auto hit = cache.find("tok-a", 1);
+        CHECK(hit && hit->sub == "a");
+        CHECK(!cache.find("tok-b", 1));
+        CHECK(cache.hits() == 1);
+        CHECK(cache.misses() == 2);
+    }
+
+    // Expiry: an expired entry is a miss and is dropped; tokens without exp
+    // aren't cached at all
+    {
+        auth::TokenCache cache(8);
+        cache.insert("old", 1, payload("a", now - 10));
+        CHECK(cache.size() == 1);
+        CHECK(!cache.find("old", 1));
+        CHECK(cache.size() == 0);
+
+        cache.insert("no-exp", 1, payload("b", 0));
+        CHECK(cache.size() == 0);
+        CHECK(!cache.find("no-exp", 1));
+    }
+
+    // Eviction: a full cache drops expired entries first...
+    {
+        auth::TokenCache cache(8);
+        for (int i = 0; i < 4; ++i) cache.insert("dead-" + std::to_string(i), 1, payload("d", now - 10));
+        for (int i = 0; i < 4; ++i) cache.insert("live-" + std::to_string(i), 1, payload("l", now + 3600));
+        CHECK(cache.size() == 8);
+        cache.insert("new", 1, payload("n", now + 3600));
+        CHECK(cache.size() == 5);
+        for (int i = 0; i < 4; ++i) CHECK(cache.find("live-" + std::to_string(i), 1).has_value());
+        CHECK(cache.find("new", 1).has_value());
+    }
+
+    // ...then live ones down to 7/8 full, and never grows past capacity
+    {
+        auth::TokenCache cache(8);
+        for (int i = 0; i < 8; ++i) cache.insert("live-" + std::to_string(i), 1, payload("l", now + 3600));
+        cache.insert("new", 1, payload("n", now + 3600));
+        CHECK(cache.size() == 7);
+        CHECK(cache.find("new", 1).has_value());
+        for (int i = 0; i < 100; ++i) {
+            cache.insert("more-" + std::to_string(i), 1, payload("m", now + 3600));
+            CHECK(cache.size() <= cache.capacity());
+        }
+    }
+
+    // Capacity 0 disables the cache
+    {
+        auth::TokenCache cache(0);
+        cache.insert("tok", 1, payload("a", now + 3600));
+        CHECK(cache.size() == 0);
+        CHECK(!cache.find("tok", 1));
+    }
+
+    // A newer key generation empties the cache; results verified with an
+    // older one are not cached
+    {
+        auth::TokenCache cache(8);
+        cache.insert("tok", 1, payload("a", now + 3600));
+        CHECK(!cache.find("tok", 2));
+        CHECK(cache.size() == 0);
+        cache.insert("stale", 1, payload("a", now + 3600));
+        CHECK(cache.size() == 0);
+        CHECK(!cache.find("tok", 1));
+    }
+
+    // verify(): validates once, then answers from the cache until a rotation
+    {
+        auth::JwtKeyRing ring;
+        ring.rotate("secret-1", 0);
+        auto keys = ring.get();
+        auth::TokenCache cache(8);
+
+        auto token = test::make_token({{"sub", "player-1"}, {"exp", now + 3600}}, "secret-1");
+        auto first = cache.verify(token, *keys);
+        CHECK(first && first->sub == "player-1");
+        CHECK(cache.misses() == 1);
+        auto second = cache.verify(token, *keys);
+        CHECK(second && second->sub == "player-1");
+        CHECK(cache.hits() == 1);
+
+        CHECK(!cache.verify(test::make_token({{"sub", "x"}, {"exp", now + 3600}}, "wrong"), *keys));
+        CHECK(cache.size() == 1);
+
+        // Without an overlap the old secret stops working at once
+        ring.rotate("secret-2", 0);
+        CHECK(!cache.verify(token, *ring.get()));
+        CHECK(cache.size() == 0);
+    }
+
+    return test::result();
+}
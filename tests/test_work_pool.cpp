@@ -0,0 +1,57 @@
+#include "check.h"
+#include "utils/work_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Every index runs exactly once, and parallel_for only returns after all of them
+static void check_runs_each_index_once(utils::WorkPool& pool, size_t n) {
+    std::vector<std::atomic<int>> calls(n);
+    pool.parallel_for(n, [&](size_t i) { calls[i].fetch_add(1, std::memory_order_relaxed); });
+    for (size_t i = 0; i < n; ++i) CHECK(calls[i].load() == 1);
+}
+
+int main() {
+    for (int workers : {0, 1, 3}) {
+        utils::WorkPool pool(workers);
+        CHECK(pool.participants() == static_cast<size_t>(workers) + 1);
+
+        for (size_t n : {0, 1, 2, 3, 7, 64, 1000}) check_runs_each_index_once(pool, n);
+
+        // Back-to-back batches reuse the same workers
+        for (int batch = 0; batch < 200; ++batch) check_runs_each_index_once(pool, 17);
+    }
+
+    // Uneven items: a few slow indices at the front get stolen around, and
+    // the join still waits for the slowest one
+    {
+        utils::WorkPool pool(3);
+        std::atomic<int> done{0};
+        pool.parallel_for(40, [&](size_t i) {
+            if (i < 4) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            done.fetch_add(1);
+        });
+        CHECK(done.load() == 40);
+    }
+
+    // Work is spread over more than one thread when items are slow
+    {
+        utils::WorkPool pool(3);
+        std::mutex mutex;
+        std::vector<std::thread::id> seen;
+        pool.parallel_for(16, [&](size_t) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            std::lock_guard lock(mutex);
+            if (std::find(seen.begin(), seen.end(), std::this_thread::get_id()) == seen.end()) {
+                seen.push_back(std::this_thread::get_id());
+            }
+        });
+        CHECK(seen.size() > 1);
+    }
+
+    return test::result();
+}